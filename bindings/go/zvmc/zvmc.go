@@ -6,7 +6,7 @@ package zvmc
 
 /*
 #cgo CFLAGS: -I${SRCDIR}/../../../include -Wall -Wextra
-#cgo !windows LDFLAGS: -ldl
+#cgo !windows LDFLAGS: -ldl -lpthread
 
 #include <zvmc/zvmc.h>
 #include <zvmc/helpers.h>
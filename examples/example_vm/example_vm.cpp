@@ -7,31 +7,158 @@
 ///
 /// This VM implements a subset of ZVM instructions in simplistic, incorrect and unsafe way:
 /// - memory bounds are not checked,
-/// - stack bounds are not checked,
+/// - stack bounds are only checked in the code blocks not validated statically,
 /// - most of the operations are done with 32-bit precision (instead of ZVM 256-bit precision).
 /// Yet, it is capable of coping with some example ZVM bytecode inputs, which is very useful
 /// in integration testing. The implementation is done in simple C++ for readability and uses
 /// pure C API and some C helpers.
 
 #include "example_vm.h"
+#include <zvmc/analysis.h>
 #include <zvmc/helpers.h>
 #include <zvmc/instructions.h>
 #include <zvmc/zvmc.h>
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
 
 /// The Example VM methods, helper and types are contained in the anonymous namespace.
 /// Technically, this limits the visibility of these elements (internal linkage).
 /// This is not strictly required, but is good practice and promotes position independent code.
 namespace
 {
+/// The superinstructions replacing common instruction sequences when the fusion is enabled.
+/// They are numbered after the ZVM opcodes.
+enum FusedOpcode : uint16_t
+{
+    OP_PUSH_JUMP = 0x100,  ///< PUSHn JUMP
+    OP_PUSH_JUMPI,         ///< PUSHn JUMPI
+    OP_ISZERO_PUSH_JUMPI,  ///< ISZERO PUSHn JUMPI
+    OP_PUSH_ADD,           ///< PUSHn ADD
+    OP_DUP1_SWAP1,         ///< DUP1 SWAP1
+};
+
+/// The number of the superinstructions.
+constexpr int num_fused_opcodes = OP_DUP1_SWAP1 - OP_PUSH_JUMP + 1;
+
+/// The number of the low bits of the decoded instruction holding the opcode,
+/// enough for the ZVM opcodes and the superinstructions.
+constexpr int op_bits = 9;
+
+/// The mask of the opcode in the decoded instruction.
+constexpr uint32_t op_mask = (uint32_t{1} << op_bits) - 1;
+static_assert(OP_DUP1_SWAP1 <= op_mask, "the superinstructions do not fit in op_bits");
+
+/// The maximum number of the PUSH instructions in the decoded code, limited by the bits
+/// of the decoded instruction left for the index of the pre-decoded value.
+constexpr size_t max_push_values = size_t{1} << (32 - op_bits);
+
+/// The names of the superinstructions used in the fusion report.
+const char* const fused_opcode_names[num_fused_opcodes] = {
+    "PUSH+JUMP", "PUSH+JUMPI", "ISZERO+PUSH+JUMPI", "PUSH+ADD", "DUP1+SWAP1",
+};
+
+/// The PUSH immediate pre-decoded into the stack item.
+///
+/// The value and the stack items are aligned to their size, so the PUSH execution is an aligned
+/// 32-byte copy.
+struct alignas(32) PushValue
+{
+    zvmc_uint256be value;  ///< The big-endian value, as the stack items.
+};
+
+/// The code pre-decoded before the execution.
+struct DecodedCode
+{
+    std::vector<uint8_t> code;          ///< The copy of the decoded code.
+    uint64_t code_hash = 0;             ///< The hash of the code, see hash_code().
+    bool fusion = false;                ///< Whether the superinstructions have been fused.
+
+    /// The code analysis with the jump destinations and the stack verdicts of the code blocks.
+    std::unique_ptr<zvmc_code_analysis, void (*)(zvmc_code_analysis*)> analysis{
+        nullptr, zvmc_free_code_analysis};
+
+    /// Marks the beginnings of the code blocks not validated statically, where the stack height
+    /// must be checked.
+    std::vector<uint8_t> stack_check;
+
+    /// The instruction at every code position: the ZVM opcode or the FusedOpcode in the op_bits
+    /// low bits. The instructions starting with a PUSH (and ISZERO+PUSH+JUMPI) have
+    /// the index of the PUSH value in the push_values in the remaining high bits.
+    std::vector<uint32_t> ops;
+
+    /// The pre-decoded values of all the PUSH instructions in the code order.
+    std::vector<PushValue> push_values;
+
+    /// The number of the fused superinstructions of every kind.
+    int fused_counts[num_fused_opcodes] = {};
+
+    /// Checks if the code position is a valid jump destination.
+    bool is_jumpdest(uint32_t pc) const noexcept
+    {
+        return zvmc_is_jumpdest(analysis.get(), pc) != 0;
+    }
+};
+
+/// The number of the instruction kinds: the ZVM opcodes followed by the superinstructions.
+constexpr int num_ops = OP_PUSH_JUMP + num_fused_opcodes;
+
+/// The per-pc execution counts of a code.
+struct CodeProfile
+{
+    /// The decoded code, providing the instructions at the code positions.
+    std::shared_ptr<const DecodedCode> code;
+
+    /// The number of executions of the instruction at every code position.
+    std::vector<uint64_t> pc_counts;
+};
+
+/// The execution profile collected when the "profile" option is enabled.
+struct Profile
+{
+    uint64_t counts[num_ops] = {};  ///< The number of executions of every instruction.
+    uint64_t cycles[num_ops] = {};  ///< The time spent in every instruction, see read_cycles().
+
+    /// The per-pc counts of the executed codes by the code hash. The counts of the executions
+    /// of the same code are merged, also if the code has been decoded again.
+    std::unordered_map<uint64_t, CodeProfile> codes;
+};
+
+/// The maximum number of the decoded codes cached by the VM instance.
+constexpr size_t max_cached_codes = 16;
+
 /// The example VM instance struct extending the zvmc_vm.
 struct ExampleVM : zvmc_vm
 {
-    int verbose = 0;  ///< The verbosity level.
-    ExampleVM();      ///< Constructor to initialize the zvmc_vm struct.
+    int verbose = 0;         ///< The verbosity level.
+    bool fusion = false;     ///< Fuse common instruction sequences into superinstructions.
+    bool profiling = false;  ///< Collect the execution profile.
+
+    std::mutex cache_mutex;  ///< The mutex guarding the decoded code cache.
+
+    /// The decoded codes of the recent executions, reused when the same code is executed again.
+    /// The most recently used first, at most max_cached_codes.
+    std::vector<std::shared_ptr<const DecodedCode>> code_cache;
+
+    std::mutex profile_mutex;  ///< The mutex guarding the profile.
+    Profile profile;           ///< The profile collected since the last report.
+
+    ExampleVM();  ///< Constructor to initialize the zvmc_vm struct.
 };
 
 /// The implementation of the zvmc_vm::destroy() method.
@@ -46,6 +173,69 @@ zvmc_capabilities_flagset get_capabilities(zvmc_vm* /*instance*/)
     return ZVMC_CAPABILITY_ZVM1;
 }
 
+/// Returns the name of the instruction or of the superinstruction.
+const char* get_op_name(uint16_t op)
+{
+    if (op >= OP_PUSH_JUMP)
+        return fused_opcode_names[op - OP_PUSH_JUMP];
+    const char* name = zvmc_get_instruction_names_table(ZVMC_SHANGHAI)[op];
+    return name != nullptr ? name : "UNDEFINED";
+}
+
+/// Prints the profile collected since the last report and restarts the profiling.
+///
+/// The instructions are ordered by the time spent in them, the hottest code positions
+/// by the number of executions. The code positions are reported with the hash of their code.
+void print_profile(ExampleVM& vm)
+{
+    std::lock_guard<std::mutex> lock{vm.profile_mutex};
+    const Profile& profile = vm.profile;
+
+    std::vector<uint16_t> ops;
+    for (int op = 0; op < num_ops; ++op)
+    {
+        if (profile.counts[op] != 0)
+            ops.push_back(static_cast<uint16_t>(op));
+    }
+    std::stable_sort(ops.begin(), ops.end(), [&profile](uint16_t a, uint16_t b) {
+        return profile.cycles[a] > profile.cycles[b];
+    });
+    std::printf("%-18s %12s %16s\n", "instruction", "count", "cycles");
+    for (const auto op : ops)
+    {
+        std::printf("%-18s %12llu %16llu\n", get_op_name(op),
+                    static_cast<unsigned long long>(profile.counts[op]),
+                    static_cast<unsigned long long>(profile.cycles[op]));
+    }
+
+    // The hottest code positions of all the codes, the ties in the code hash and pc order.
+    constexpr size_t max_hot_pcs = 10;
+    std::vector<std::tuple<uint64_t, uint64_t, uint32_t>> pcs;  // The count, the hash and the pc.
+    for (const auto& [code_hash, code_profile] : profile.codes)
+    {
+        for (size_t pc = 0; pc < code_profile.pc_counts.size(); ++pc)
+        {
+            if (code_profile.pc_counts[pc] != 0)
+                pcs.emplace_back(code_profile.pc_counts[pc], code_hash, static_cast<uint32_t>(pc));
+        }
+    }
+    std::sort(pcs.begin(), pcs.end(), [](const auto& a, const auto& b) {
+        return std::get<0>(a) != std::get<0>(b) ? std::get<0>(a) > std::get<0>(b) : a < b;
+    });
+    if (pcs.size() > max_hot_pcs)
+        pcs.resize(max_hot_pcs);
+    std::printf("%-18s %12s %16s %18s\n", "pc", "count", "instruction", "code");
+    for (const auto& [count, code_hash, pc] : pcs)
+    {
+        const DecodedCode& code = *profile.codes.at(code_hash).code;
+        std::printf("%-18u %12llu %16s   %016llx\n", pc, static_cast<unsigned long long>(count),
+                    get_op_name(static_cast<uint16_t>(code.ops[pc] & op_mask)),
+                    static_cast<unsigned long long>(code_hash));
+    }
+
+    vm.profile = Profile{};
+}
+
 /// Example VM options.
 ///
 /// The implementation of the zvmc_vm::set_option() method.
@@ -68,14 +258,41 @@ enum zvmc_set_option_result set_option(zvmc_vm* instance, const char* name, cons
         return ZVMC_SET_OPTION_SUCCESS;
     }
 
+    if (std::strcmp(name, "fusion") == 0)
+    {
+        if (value == nullptr || (std::strcmp(value, "0") != 0 && std::strcmp(value, "1") != 0))
+            return ZVMC_SET_OPTION_INVALID_VALUE;
+        vm->fusion = value[0] == '1';
+        return ZVMC_SET_OPTION_SUCCESS;
+    }
+
+    // The "1" enables the profiling, the "0" disables it and the "report" prints the profile.
+    if (std::strcmp(name, "profile") == 0)
+    {
+        if (value != nullptr && std::strcmp(value, "report") == 0)
+        {
+            print_profile(*vm);
+            return ZVMC_SET_OPTION_SUCCESS;
+        }
+        if (value == nullptr || (std::strcmp(value, "0") != 0 && std::strcmp(value, "1") != 0))
+            return ZVMC_SET_OPTION_INVALID_VALUE;
+        vm->profiling = value[0] == '1';
+        return ZVMC_SET_OPTION_SUCCESS;
+    }
+
     return ZVMC_SET_OPTION_INVALID_NAME;
 }
 
 /// The Example VM stack representation.
-struct Stack
+///
+/// The items are aligned as the pre-decoded PushValue.
+struct alignas(32) Stack
 {
-    zvmc_uint256be items[1024] = {};  ///< The array of stack items.
-    zvmc_uint256be* pointer = items;  ///< The pointer to the currently first empty stack slot.
+    zvmc_uint256be items[ZVMC_STACK_LIMIT] = {};  ///< The array of stack items.
+    zvmc_uint256be* pointer = items;              ///< The pointer to the first empty stack slot.
+
+    /// Returns the number of the stack items.
+    int32_t size() const { return static_cast<int32_t>(pointer - items); }
 
     /// Pops an item from the top of the stack.
     zvmc_uint256be pop() { return *--pointer; }
@@ -148,6 +365,20 @@ inline uint32_t to_uint32(zvmc_uint256be value)
            (uint32_t{value.bytes[30]} << 8) | (uint32_t{value.bytes[31]});
 }
 
+/// Checks if 256-bit value is zero.
+inline bool is_zero(const zvmc_uint256be& value)
+{
+    return std::all_of(std::begin(value.bytes), std::end(value.bytes),
+                       [](uint8_t b) { return b == 0; });
+}
+
+/// Checks if 256-bit value fits 32 bits.
+inline bool fits_uint32(const zvmc_uint256be& value)
+{
+    return std::all_of(std::begin(value.bytes), std::end(value.bytes) - 4,
+                       [](uint8_t b) { return b == 0; });
+}
+
 /// Truncates 256-bit value to 160-bit address.
 inline zvmc_address to_address(zvmc_uint256be value)
 {
@@ -157,33 +388,336 @@ inline zvmc_address to_address(zvmc_uint256be value)
     return address;
 }
 
+/// Returns the number of the immediate bytes of the PUSH instruction.
+inline size_t num_push_bytes(uint8_t opcode)
+{
+    return size_t{opcode} - OP_PUSH1 + 1;
+}
 
-/// The example implementation of the zvmc_vm::execute() method.
-zvmc_result execute(zvmc_vm* instance,
-                    const zvmc_host_interface* host,
-                    zvmc_host_context* context,
-                    enum zvmc_revision /*rev*/,
-                    const zvmc_message* msg,
-                    const uint8_t* code,
-                    size_t code_size)
+/// Reads the complete PUSH immediate at the code position.
+/// Returns false if the position is not a PUSH instruction or the immediate is truncated
+/// by the end of the code.
+bool read_push_value(const uint8_t* code, size_t code_size, size_t pc, zvmc_uint256be& value)
 {
-    auto* vm = static_cast<ExampleVM*>(instance);
+    if (pc >= code_size || code[pc] < OP_PUSH1 || code[pc] > OP_PUSH32)
+        return false;
+    const size_t size = num_push_bytes(code[pc]);
+    if (code_size - pc - 1 < size)
+        return false;
+    value = {};
+    std::memcpy(&value.bytes[sizeof(value) - size], &code[pc + 1], size);
+    return true;
+}
 
-    if (vm->verbose > 0)
-        std::puts("execution started\n");
+/// Pre-decodes the values of all the PUSH instructions and stores their indices in the ops.
+/// Returns false if the code has more than max_push_values PUSH instructions.
+bool decode_push_values(DecodedCode& decoded, const zvmc_instruction_info* info)
+{
+    const uint8_t* code = decoded.code.data();
+    const size_t code_size = decoded.code.size();
+
+    for (size_t pc = 0; pc < code_size; pc += 1 + info[code[pc]].immediate_size)
+    {
+        if (code[pc] < OP_PUSH1 || code[pc] > OP_PUSH32)
+            continue;
+
+        if (decoded.push_values.size() == max_push_values)
+            return false;
+
+        // The PUSH data truncated by the end of the code is padded with zeros.
+        PushValue push_value = {};
+        const size_t push_size = num_push_bytes(code[pc]);
+        const size_t data_size = std::min(push_size, code_size - pc - 1);
+        std::memcpy(&push_value.value.bytes[sizeof(zvmc_uint256be) - push_size], &code[pc + 1],
+                    data_size);
+        decoded.ops[pc] |= static_cast<uint32_t>(decoded.push_values.size()) << op_bits;
+        decoded.push_values.push_back(push_value);
+    }
+    return true;
+}
+
+/// Replaces the common instruction sequences with the superinstructions.
+///
+/// The superinstructions use the pre-decoded values of their PUSH instructions, the index
+/// of the value is moved to the first instruction of the sequence.
+/// Only the sequences of complete instructions are fused. The jumps into the middle of
+/// a superinstruction are not possible because none of them includes a JUMPDEST.
+void fuse(DecodedCode& decoded, const zvmc_instruction_info* info)
+{
+    const uint8_t* code = decoded.code.data();
+    const size_t code_size = decoded.code.size();
+
+    size_t pc = 0;
+    while (pc < code_size)
+    {
+        // The position of the instruction following the current one.
+        const size_t next = pc + 1 + info[code[pc]].immediate_size;
+
+        zvmc_uint256be value = {};
+        uint16_t fused = 0;
+        size_t push_pc = pc;  // The position of the PUSH of the sequence.
+        size_t end = next;    // The position after the fused sequence.
+        if (code[pc] == OP_ISZERO && read_push_value(code, code_size, next, value))
+        {
+            const size_t jumpi_pc = next + 1 + num_push_bytes(code[next]);
+            if (jumpi_pc < code_size && code[jumpi_pc] == OP_JUMPI && fits_uint32(value))
+            {
+                fused = OP_ISZERO_PUSH_JUMPI;
+                push_pc = next;
+                end = jumpi_pc + 1;
+            }
+        }
+        else if (read_push_value(code, code_size, pc, value) && next < code_size)
+        {
+            if (code[next] == OP_JUMP && fits_uint32(value))
+                fused = OP_PUSH_JUMP;
+            else if (code[next] == OP_JUMPI && fits_uint32(value))
+                fused = OP_PUSH_JUMPI;
+            else if (code[next] == OP_ADD)
+                fused = OP_PUSH_ADD;
+            end = next + 1;
+        }
+        else if (code[pc] == OP_DUP1 && next < code_size && code[next] == OP_SWAP1)
+        {
+            fused = OP_DUP1_SWAP1;
+            end = next + 1;
+        }
+
+        if (fused == 0)
+        {
+            pc = next;
+            continue;
+        }
+
+        decoded.ops[pc] = fused | (decoded.ops[push_pc] & ~op_mask);
+        ++decoded.fused_counts[fused - OP_PUSH_JUMP];
+        pc = end;
+    }
+}
+
+/// Computes the FNV-1a hash of the code, the key of the decoded code cache.
+uint64_t hash_code(const uint8_t* code, size_t code_size) noexcept
+{
+    uint64_t h = 0xcbf29ce484222325;
+    for (size_t i = 0; i < code_size; ++i)
+        h = (h ^ code[i]) * 0x100000001b3;
+    return h;
+}
+
+/// Finds the decoded code in the cache and makes it the most recently used one.
+/// Returns null if not found.
+std::shared_ptr<const DecodedCode> find_cached_code(ExampleVM& vm,
+                                                    const uint8_t* code,
+                                                    size_t code_size,
+                                                    uint64_t code_hash)
+{
+    std::shared_ptr<const DecodedCode> cached;
+    {
+        // Only the keys are compared under the lock, so the executions wait for each other
+        // only shortly.
+        std::lock_guard<std::mutex> lock{vm.cache_mutex};
+        auto& cache = vm.code_cache;
+        const auto it = std::find_if(cache.begin(), cache.end(), [&](const auto& c) {
+            return c->code_hash == code_hash && c->code.size() == code_size &&
+                   c->fusion == vm.fusion;
+        });
+        if (it == cache.end())
+            return nullptr;
+        std::rotate(cache.begin(), it, it + 1);
+        cached = cache.front();
+    }
+
+    // The hash collisions are not trusted.
+    if (!std::equal(code, code + code_size, cached->code.begin()))
+        return nullptr;
+    return cached;
+}
+
+/// Decodes the code, reusing the result of a recent execution of the same code.
+/// Returns null if the code cannot be analyzed or has more than max_push_values PUSHes.
+std::shared_ptr<const DecodedCode> decode(ExampleVM& vm, const uint8_t* code, size_t code_size)
+{
+    const uint64_t code_hash = hash_code(code, code_size);
+    if (auto cached = find_cached_code(vm, code, code_size, code_hash))
+        return cached;
+
+    auto decoded = std::make_shared<DecodedCode>();
+    decoded->code.assign(code, code + code_size);
+    decoded->code_hash = code_hash;
+    decoded->fusion = vm.fusion;
+    decoded->analysis.reset(zvmc_analyze_code(ZVMC_SHANGHAI, code, code_size));
+    if (!decoded->analysis)
+        return nullptr;
+    decoded->stack_check.resize(code_size);
+    for (size_t i = 0; i < decoded->analysis->num_blocks; ++i)
+    {
+        const zvmc_code_block& block = decoded->analysis->blocks[i];
+        if (block.stack_verdict != ZVMC_STACK_VALID)
+            decoded->stack_check[block.begin] = 1;
+    }
+    decoded->ops.assign(code, code + code_size);
+    const zvmc_instruction_info* info = zvmc_get_instruction_info_table(ZVMC_SHANGHAI);
+    if (!decode_push_values(*decoded, info))
+        return nullptr;
+    if (vm.fusion)
+    {
+        fuse(*decoded, info);
+        if (vm.verbose > 0)
+        {
+            std::printf("fused instructions:");
+            for (int i = 0; i < num_fused_opcodes; ++i)
+                std::printf(" %s %d", fused_opcode_names[i], decoded->fused_counts[i]);
+            std::printf("\n");
+        }
+    }
+
+    // The least recently used code is evicted.
+    std::lock_guard<std::mutex> lock{vm.cache_mutex};
+    auto& cache = vm.code_cache;
+    if (cache.size() == max_cached_codes)
+        cache.pop_back();
+    cache.insert(cache.begin(), decoded);
+    return decoded;
+}
+
+/// Reads the CPU timestamp counter or, where it is not available, the monotonic clock.
+inline uint64_t read_cycles()
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/// The instrumentation of the execution loop.
+///
+/// The loop is instantiated for the both variants, so the disabled profiler compiles to nothing.
+template <bool Enabled>
+struct Profiler
+{
+    Profiler(ExampleVM& /*vm*/, const std::shared_ptr<const DecodedCode>& /*code*/) {}
+
+    /// Records the start of the instruction execution.
+    void enter(size_t /*pc*/, uint16_t /*op*/) {}
+};
+
+/// The profiler collecting the profile of a single execution.
+///
+/// The profile is merged into the VM one at the end of the execution, so the executions
+/// do not contend for the VM profile.
+template <>
+struct Profiler<true>
+{
+    ExampleVM& vm;
+    Profile profile;
+    int current_op = -1;         ///< The instruction being executed.
+    uint64_t current_start = 0;  ///< The start time of the instruction being executed.
+
+    std::shared_ptr<const DecodedCode> code;  ///< The executed code.
+    std::vector<uint64_t> pc_counts;          ///< The per-pc counts of this execution.
+
+    Profiler(ExampleVM& target_vm, const std::shared_ptr<const DecodedCode>& executed_code)
+      : vm{target_vm}, code{executed_code}, pc_counts(executed_code->code.size())
+    {}
+
+    /// Records the start of the instruction execution, what ends the previous one.
+    void enter(size_t pc, uint16_t op)
+    {
+        const uint64_t now = read_cycles();
+        if (current_op >= 0)
+            profile.cycles[current_op] += now - current_start;
+        ++profile.counts[op];
+        ++pc_counts[pc];
+        current_op = op;
+        current_start = now;
+    }
+
+    ~Profiler()
+    {
+        if (current_op >= 0)
+            profile.cycles[current_op] += read_cycles() - current_start;
+
+        std::lock_guard<std::mutex> lock{vm.profile_mutex};
+        Profile& total = vm.profile;
+        for (int op = 0; op < num_ops; ++op)
+        {
+            total.counts[op] += profile.counts[op];
+            total.cycles[op] += profile.cycles[op];
+        }
+
+        CodeProfile& code_profile = total.codes[code->code_hash];
+        if (!code_profile.code)
+        {
+            code_profile.code = std::move(code);
+            code_profile.pc_counts = std::move(pc_counts);
+            return;
+        }
+        // The per-pc counts of a different code with the same hash are dropped.
+        if (code_profile.code != code && code_profile.code->code != code->code)
+            return;
+        for (size_t pc = 0; pc < pc_counts.size(); ++pc)
+            code_profile.pc_counts[pc] += pc_counts[pc];
+    }
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+};
+
+/// Executes the decoded code, with the profiler enabled or disabled.
+template <bool Profiling>
+zvmc_result execute_code(ExampleVM& vm,
+                         const std::shared_ptr<const DecodedCode>& decoded,
+                         const zvmc_host_interface* host,
+                         zvmc_host_context* context,
+                         const zvmc_message* msg)
+{
+    Profiler<Profiling> profiler{vm, decoded};
+
+    const uint8_t* code = decoded->code.data();
+    const size_t code_size = decoded->code.size();
+    const uint32_t* ops = decoded->ops.data();
+    const PushValue* push_values = decoded->push_values.data();
+    const zvmc_instruction_info* info = zvmc_get_instruction_info_table(ZVMC_SHANGHAI);
 
     int64_t gas_left = msg->gas;
     Stack stack;
     Memory memory;
 
-    for (size_t pc = 0; pc < code_size; ++pc)
+    // The end of the code block executed with the stack height checks.
+    size_t checked_end = 0;
+
+    size_t pc = 0;
+    while (pc < code_size)
     {
+        // The blocks with the unknown entry stack height are checked as a whole at the entry.
+        // The blocks which may fail are executed without the superinstructions and with
+        // the stack height checked for every instruction, to fail at the right instruction.
+        if (decoded->stack_check[pc] != 0)
+        {
+            const zvmc_code_block* block = zvmc_find_code_block(decoded->analysis.get(), pc);
+            checked_end = zvmc_check_block_stack(block, stack.size()) ? 0 : block->end;
+        }
+        const bool checked = pc < checked_end;
+        const uint16_t op = checked ? code[pc] : static_cast<uint16_t>(ops[pc] & op_mask);
+
+        profiler.enter(pc, op);
+
         // Check remaining gas, assume each instruction costs 1.
+        // The superinstructions charge the remaining instructions they replace.
         gas_left -= 1;
         if (gas_left < 0)
             return zvmc_make_result(ZVMC_OUT_OF_GAS, 0, 0, nullptr, 0);
 
-        switch (code[pc])
+        if (checked)
+        {
+            if (stack.size() < info[op].stack_height_required)
+                return zvmc_make_result(ZVMC_STACK_UNDERFLOW, 0, 0, nullptr, 0);
+            if (stack.size() + info[op].stack_height_change > ZVMC_STACK_LIMIT)
+                return zvmc_make_result(ZVMC_STACK_OVERFLOW, 0, 0, nullptr, 0);
+        }
+
+        switch (op)
         {
         default:
             return zvmc_make_result(ZVMC_UNDEFINED_INSTRUCTION, 0, 0, nullptr, 0);
@@ -200,6 +734,13 @@ zvmc_result execute(zvmc_vm* instance,
             break;
         }
 
+        case OP_ISZERO:
+        {
+            zvmc_uint256be value = stack.pop();
+            stack.push(to_uint256(is_zero(value) ? 1 : 0));
+            break;
+        }
+
         case OP_ADDRESS:
         {
             zvmc_uint256be value = to_uint256(msg->recipient);
@@ -255,6 +796,30 @@ zvmc_result execute(zvmc_vm* instance,
             break;
         }
 
+        case OP_JUMP:
+        {
+            zvmc_uint256be dest = stack.pop();
+            if (!fits_uint32(dest) || !decoded->is_jumpdest(to_uint32(dest)))
+                return zvmc_make_result(ZVMC_BAD_JUMP_DESTINATION, 0, 0, nullptr, 0);
+            pc = to_uint32(dest);
+            continue;
+        }
+
+        case OP_JUMPI:
+        {
+            zvmc_uint256be dest = stack.pop();
+            zvmc_uint256be condition = stack.pop();
+            if (is_zero(condition))
+                break;
+            if (!fits_uint32(dest) || !decoded->is_jumpdest(to_uint32(dest)))
+                return zvmc_make_result(ZVMC_BAD_JUMP_DESTINATION, 0, 0, nullptr, 0);
+            pc = to_uint32(dest);
+            continue;
+        }
+
+        case OP_JUMPDEST:
+            break;
+
         case OP_MSIZE:
         {
             zvmc_uint256be value = to_uint256(memory.size);
@@ -295,12 +860,8 @@ zvmc_result execute(zvmc_vm* instance,
         case OP_PUSH31:
         case OP_PUSH32:
         {
-            zvmc_uint256be value = {};
-            size_t num_push_bytes = size_t{code[pc]} - OP_PUSH1 + 1;
-            size_t offset = sizeof(value) - num_push_bytes;
-            std::memcpy(&value.bytes[offset], &code[pc + 1], num_push_bytes);
-            pc += num_push_bytes;
-            stack.push(value);
+            stack.push(push_values[ops[pc] >> op_bits].value);
+            pc += num_push_bytes(code[pc]);
             break;
         }
 
@@ -312,6 +873,15 @@ zvmc_result execute(zvmc_vm* instance,
             break;
         }
 
+        case OP_SWAP1:
+        {
+            zvmc_uint256be a = stack.pop();
+            zvmc_uint256be b = stack.pop();
+            stack.push(a);
+            stack.push(b);
+            break;
+        }
+
         case OP_CALL:
         {
             zvmc_message call_msg = {};
@@ -366,12 +936,93 @@ zvmc_result execute(zvmc_vm* instance,
 
             return zvmc_make_result(ZVMC_REVERT, gas_left, 0, output_ptr, output_size);
         }
+
+        case OP_PUSH_JUMP:
+        {
+            gas_left -= 1;
+            if (gas_left < 0)
+                return zvmc_make_result(ZVMC_OUT_OF_GAS, 0, 0, nullptr, 0);
+            const uint32_t dest = to_uint32(push_values[ops[pc] >> op_bits].value);
+            if (!decoded->is_jumpdest(dest))
+                return zvmc_make_result(ZVMC_BAD_JUMP_DESTINATION, 0, 0, nullptr, 0);
+            pc = dest;
+            continue;
+        }
+
+        case OP_PUSH_JUMPI:
+        case OP_ISZERO_PUSH_JUMPI:
+        {
+            const bool negated = op == OP_ISZERO_PUSH_JUMPI;
+            gas_left -= negated ? 2 : 1;
+            if (gas_left < 0)
+                return zvmc_make_result(ZVMC_OUT_OF_GAS, 0, 0, nullptr, 0);
+            const size_t push_pc = negated ? pc + 1 : pc;
+            zvmc_uint256be condition = stack.pop();
+            if (is_zero(condition) == negated)
+            {
+                const uint32_t dest = to_uint32(push_values[ops[pc] >> op_bits].value);
+                if (!decoded->is_jumpdest(dest))
+                    return zvmc_make_result(ZVMC_BAD_JUMP_DESTINATION, 0, 0, nullptr, 0);
+                pc = dest;
+                continue;
+            }
+            pc = push_pc + num_push_bytes(code[push_pc]) + 1;
+            break;
         }
+
+        case OP_PUSH_ADD:
+        {
+            gas_left -= 1;
+            if (gas_left < 0)
+                return zvmc_make_result(ZVMC_OUT_OF_GAS, 0, 0, nullptr, 0);
+            uint32_t a = to_uint32(push_values[ops[pc] >> op_bits].value);
+            uint32_t b = to_uint32(stack.pop());
+            stack.push(to_uint256(a + b));
+            pc += num_push_bytes(code[pc]) + 1;
+            break;
+        }
+
+        case OP_DUP1_SWAP1:
+        {
+            // The SWAP1 of the two copies of the same value has no effect.
+            gas_left -= 1;
+            if (gas_left < 0)
+                return zvmc_make_result(ZVMC_OUT_OF_GAS, 0, 0, nullptr, 0);
+            zvmc_uint256be value = stack.pop();
+            stack.push(value);
+            stack.push(value);
+            pc += 1;
+            break;
+        }
+        }
+        ++pc;
     }
 
     return zvmc_make_result(ZVMC_SUCCESS, gas_left, 0, nullptr, 0);
 }
 
+/// The example implementation of the zvmc_vm::execute() method.
+zvmc_result execute(zvmc_vm* instance,
+                    const zvmc_host_interface* host,
+                    zvmc_host_context* context,
+                    enum zvmc_revision /*rev*/,
+                    const zvmc_message* msg,
+                    const uint8_t* code,
+                    size_t code_size)
+{
+    auto* vm = static_cast<ExampleVM*>(instance);
+
+    if (vm->verbose > 0)
+        std::puts("execution started\n");
+
+    const auto decoded = decode(*vm, code, code_size);
+    if (!decoded)
+        return zvmc_make_result(ZVMC_FAILURE, 0, 0, nullptr, 0);
+    if (vm->profiling)
+        return execute_code<true>(*vm, decoded, host, context, msg);
+    return execute_code<false>(*vm, decoded, host, context, msg);
+}
+
 
 /// @cond internal
 #if !defined(PROJECT_VERSION)
@@ -0,0 +1,226 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+/**
+ * ZVM Code Analysis
+ *
+ * The analysis of ZVM bytecode shared by VM implementations and tools: the map of valid jump
+ * destinations, the map of PUSH data and the basic blocks with their static gas cost,
+ * stack height requirements and the verdicts of the static stack height validation.
+ *
+ * The analysis only depends on the code and the revision, so it can be computed once
+ * (e.g. when the code is deployed) and cached together with the code.
+ *
+ * @defgroup analysis ZVM Code Analysis
+ * @{
+ */
+#pragma once
+
+#include <zvmc/utils.h>
+#include <zvmc/zvmc.h>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** The maximum number of the ZVM stack items. */
+enum
+{
+    ZVMC_STACK_LIMIT = 1024
+};
+
+/**
+ * The verdict of the static validation of the block stack height.
+ *
+ * The VMs may execute the instructions of a block without the stack underflow and overflow
+ * checks if the verdict is ::ZVMC_STACK_VALID or if zvmc_check_block_stack() passes for
+ * the stack height at the block entry.
+ */
+enum zvmc_stack_verdict
+{
+    /**
+     * The stack height at the block entry is not known statically, e.g. the block is a jump
+     * destination. The stack height must be checked at the block entry.
+     */
+    ZVMC_STACK_CHECK_ENTRY = 0,
+
+    /** The stack can neither underflow nor overflow in the block. */
+    ZVMC_STACK_VALID = 1,
+
+    /**
+     * The stack underflows or overflows in the block. The instructions must be checked
+     * one by one to find the failing one.
+     */
+    ZVMC_STACK_INVALID = 2
+};
+
+/**
+ * The basic block of ZVM code.
+ *
+ * A basic block is a sequence of instructions which is always executed from the beginning.
+ * A new block begins at every JUMPDEST and after every instruction which ends or redirects
+ * the execution (JUMP, JUMPI, STOP, RETURN, REVERT, INVALID and undefined instructions).
+ */
+struct zvmc_code_block
+{
+    /** The offset of the first instruction of the block. */
+    uint32_t begin;
+
+    /** The offset past the last instruction of the block, including its PUSH data. */
+    uint32_t end;
+
+    /** The sum of the static gas costs of all the block instructions. */
+    int64_t gas_cost;
+
+    /** The minimum stack height required at the block entry to execute all the instructions. */
+    int32_t stack_height_required;
+
+    /** The maximum stack height growth relative to the stack height at the block entry. */
+    int32_t stack_height_max_growth;
+
+    /** The stack height change caused by the execution of the whole block. */
+    int32_t stack_height_change;
+
+    /**
+     * The stack height at the block entry or -1 if it is not known statically.
+     *
+     * The height is known for the code beginning and for the blocks only entered by
+     * the fall-through from a JUMPI of a block with the known height.
+     */
+    int32_t stack_height_entry;
+
+    /** The verdict of the static stack height validation. */
+    enum zvmc_stack_verdict stack_verdict;
+};
+
+/**
+ * The result of the ZVM code analysis.
+ *
+ * All the data is kept in a single allocation released with zvmc_free_code_analysis().
+ */
+struct zvmc_code_analysis
+{
+    /** The size of the analyzed code. */
+    size_t code_size;
+
+    /**
+     * The bitmap of the valid jump destinations.
+     *
+     * The bit `i % 8` of the byte `i / 8` is set if the code byte `i` is a JUMPDEST instruction
+     * (not the PUSH data). The bitmap has `(code_size + 7) / 8` bytes.
+     */
+    const uint8_t* jumpdest_map;
+
+    /**
+     * The bitmap of the PUSH data, in the layout of the jumpdest_map.
+     *
+     * The bit is set if the code byte is the immediate data of a PUSH instruction.
+     */
+    const uint8_t* push_data_map;
+
+    /** The number of basic blocks. */
+    size_t num_blocks;
+
+    /** The basic blocks ordered by their offsets. The blocks cover the whole code. */
+    const struct zvmc_code_block* blocks;
+};
+
+/**
+ * Analyzes the ZVM code.
+ *
+ * The gas costs and stack requirements come from the instruction metadata of the revision,
+ * see zvmc_get_instruction_info_table().
+ *
+ * @param revision   The ZVM revision.
+ * @param code       The reference to the code to analyze. May be NULL if code_size is 0.
+ * @param code_size  The size of the code.
+ * @return           The code analysis or NULL in case of invalid revision, the code larger than
+ *                   4 GB or memory allocation failure.
+ */
+ZVMC_EXPORT struct zvmc_code_analysis* zvmc_analyze_code(enum zvmc_revision revision,
+                                                         const uint8_t* code,
+                                                         size_t code_size);
+
+/**
+ * Computes the bitmaps of the valid jump destinations and of the PUSH data.
+ *
+ * This is the part of zvmc_analyze_code() for VMs only needing to validate jumps.
+ * The code is scanned in chunks of 64 bytes, using SIMD instructions where available.
+ *
+ * @param code           The reference to the code to analyze. May be NULL if code_size is 0.
+ * @param code_size      The size of the code.
+ * @param jumpdest_map   The output bitmap of `(code_size + 7) / 8` bytes, in the layout of
+ *                       zvmc_code_analysis::jumpdest_map. Every byte is written.
+ * @param push_data_map  The optional output bitmap of PUSH data of the same size. May be NULL.
+ */
+ZVMC_EXPORT void zvmc_analyze_jumpdests(const uint8_t* code,
+                                        size_t code_size,
+                                        uint8_t* jumpdest_map,
+                                        uint8_t* push_data_map);
+
+/**
+ * Releases the code analysis.
+ *
+ * @param analysis  The code analysis returned by zvmc_analyze_code(). May be NULL.
+ */
+ZVMC_EXPORT void zvmc_free_code_analysis(struct zvmc_code_analysis* analysis);
+
+/**
+ * Finds the basic block containing the given code offset.
+ *
+ * @param analysis  The code analysis.
+ * @param offset    The code offset.
+ * @return          The pointer to the block or NULL if the offset is outside of the code.
+ */
+ZVMC_EXPORT const struct zvmc_code_block* zvmc_find_code_block(
+    const struct zvmc_code_analysis* analysis,
+    size_t offset);
+
+/**
+ * Checks if the stack can neither underflow nor overflow in the block.
+ *
+ * @param block         The code block.
+ * @param stack_height  The stack height at the block entry.
+ * @return              Non-zero if the block instructions need no stack height checks.
+ */
+static inline int zvmc_check_block_stack(const struct zvmc_code_block* block, int32_t stack_height)
+{
+    return stack_height >= block->stack_height_required &&
+           stack_height <= ZVMC_STACK_LIMIT - block->stack_height_max_growth;
+}
+
+/**
+ * Checks if the code offset is a valid jump destination.
+ *
+ * @param analysis  The code analysis.
+ * @param offset    The code offset.
+ * @return          Non-zero if the offset points to a JUMPDEST instruction.
+ */
+static inline int zvmc_is_jumpdest(const struct zvmc_code_analysis* analysis, size_t offset)
+{
+    return offset < analysis->code_size &&
+           (analysis->jumpdest_map[offset / 8] & (1u << (offset % 8))) != 0;
+}
+
+/**
+ * Checks if the code offset is the immediate data of a PUSH instruction.
+ *
+ * @param analysis  The code analysis.
+ * @param offset    The code offset.
+ * @return          Non-zero if the offset points to PUSH data.
+ */
+static inline int zvmc_is_push_data(const struct zvmc_code_analysis* analysis, size_t offset)
+{
+    return offset < analysis->code_size &&
+           (analysis->push_data_map[offset / 8] & (1u << (offset % 8))) != 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */
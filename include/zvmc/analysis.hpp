@@ -0,0 +1,70 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+#pragma once
+
+#include <zvmc/analysis.h>
+#include <zvmc/zvmc.hpp>
+
+#include <memory>
+#include <stdexcept>
+
+namespace zvmc
+{
+/// The analysis of ZVM code.
+///
+/// This is the RAII wrapper for ::zvmc_code_analysis.
+class CodeAnalysis
+{
+    std::unique_ptr<zvmc_code_analysis, decltype(&zvmc_free_code_analysis)> m_analysis;
+
+public:
+    /// Analyzes the code, see zvmc_analyze_code().
+    ///
+    /// @throws std::invalid_argument  In case the code cannot be analyzed.
+    CodeAnalysis(zvmc_revision rev, bytes_view code)
+      : m_analysis{zvmc_analyze_code(rev, code.data(), code.size()), zvmc_free_code_analysis}
+    {
+        if (!m_analysis)
+            throw std::invalid_argument{"cannot analyze code"};
+    }
+
+    /// The size of the analyzed code.
+    size_t code_size() const noexcept { return m_analysis->code_size; }
+
+    /// Checks if the code offset is a valid jump destination.
+    bool is_jumpdest(size_t offset) const noexcept
+    {
+        return zvmc_is_jumpdest(m_analysis.get(), offset) != 0;
+    }
+
+    /// Checks if the code offset is the immediate data of a PUSH instruction.
+    bool is_push_data(size_t offset) const noexcept
+    {
+        return zvmc_is_push_data(m_analysis.get(), offset) != 0;
+    }
+
+    /// The number of basic blocks.
+    size_t num_blocks() const noexcept { return m_analysis->num_blocks; }
+
+    /// The iterator to the first basic block.
+    const zvmc_code_block* begin() const noexcept { return m_analysis->blocks; }
+
+    /// The iterator past the last basic block.
+    const zvmc_code_block* end() const noexcept
+    {
+        return m_analysis->blocks + m_analysis->num_blocks;
+    }
+
+    /// Finds the basic block containing the code offset.
+    ///
+    /// @return  The pointer to the block or null if the offset is outside of the code.
+    const zvmc_code_block* find_block(size_t offset) const noexcept
+    {
+        return zvmc_find_code_block(m_analysis.get(), offset);
+    }
+
+    /// Provides access to the raw analysis.
+    const zvmc_code_analysis* get_raw_pointer() const noexcept { return m_analysis.get(); }
+};
+}  // namespace zvmc
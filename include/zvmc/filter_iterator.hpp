@@ -3,8 +3,34 @@
 // Licensed under the Apache License, Version 2.0.
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ZVMC_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+// The AVX2 kernels are compiled for the AVX2 target independently of the compiler flags and
+// selected at run time, so all translation units see the same definitions of inline functions.
+#if (defined(__x86_64__) || defined(__i386__) || defined(_M_X64)) && \
+    (defined(__GNUC__) || defined(_MSC_VER))
+#define ZVMC_SIMD_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#define ZVMC_TARGET_AVX2
+#else
+#define ZVMC_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define ZVMC_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace zvmc
 {
 /// The constexpr variant of std::isspace().
@@ -20,6 +46,149 @@ inline constexpr bool is_not_space(char ch) noexcept
     return !isspace(ch);
 }
 
+namespace internal
+{
+/// Checks if the call is evaluated in a constant expression, so the SIMD kernels, which are not
+/// constexpr, must be skipped. Without the compiler builtin the scans are not usable
+/// in constant expressions.
+inline constexpr bool is_constant_evaluated() noexcept
+{
+#if (defined(__GNUC__) && (__GNUC__ >= 9 || defined(__clang__))) || \
+    (defined(_MSC_VER) && _MSC_VER >= 1925)
+    return __builtin_is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+/// Returns the index of the lowest set bit. The @p x must not be zero.
+inline int count_trailing_zeros(uint64_t x) noexcept
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+    if (_BitScanForward(&index, static_cast<unsigned long>(x)))
+        return static_cast<int>(index);
+    _BitScanForward(&index, static_cast<unsigned long>(x >> 32));
+    return static_cast<int>(index) + 32;
+#else
+    return __builtin_ctzll(x);
+#endif
+}
+
+#ifdef ZVMC_SIMD_AVX2
+/// Checks if the CPU supports the AVX2 instructions. The result is computed once.
+inline bool has_avx2() noexcept
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    static const bool supported = [] {
+        int info[4];
+        __cpuid(info, 1);
+        // The OS must save the YMM registers (OSXSAVE and the XCR0 bits 1 and 2).
+        if ((info[2] & (1 << 27)) == 0 || (_xgetbv(0) & 6) != 6)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+    }();
+    return supported;
+#else
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#endif
+}
+#endif
+
+#ifdef ZVMC_SIMD_SSE2
+/// Returns the bit mask of whitespace characters in the block of 16 characters. SSE2 version.
+inline uint64_t space_mask_sse2(const char* p) noexcept
+{
+    const auto c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const auto is_blank = _mm_cmpeq_epi8(c, _mm_set1_epi8(' '));
+    // The characters '\t'..'\r' are the ones with c - '\t' <= 4 (unsigned).
+    const auto x = _mm_sub_epi8(c, _mm_set1_epi8('\t'));
+    const auto is_control = _mm_cmpeq_epi8(_mm_min_epu8(x, _mm_set1_epi8(4)), x);
+    return static_cast<uint16_t>(_mm_movemask_epi8(_mm_or_si128(is_blank, is_control)));
+}
+#endif
+
+#ifdef ZVMC_SIMD_AVX2
+/// Returns the bit mask of whitespace characters in the block of 32 characters. AVX2 version.
+ZVMC_TARGET_AVX2 inline uint64_t space_mask_avx2(const char* p) noexcept
+{
+    const auto c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const auto is_blank = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' '));
+    const auto x = _mm256_sub_epi8(c, _mm256_set1_epi8('\t'));
+    const auto is_control = _mm256_cmpeq_epi8(_mm256_min_epu8(x, _mm256_set1_epi8(4)), x);
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(is_blank, is_control)));
+}
+#endif
+
+#ifdef ZVMC_SIMD_NEON
+/// Returns the mask of whitespace characters in the block of 16 characters with 4 bits
+/// per character. NEON version.
+inline uint64_t space_mask_neon(const char* p) noexcept
+{
+    const auto c = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    const auto is_blank = vceqq_u8(c, vdupq_n_u8(' '));
+    const auto is_control = vcleq_u8(vsubq_u8(c, vdupq_n_u8('\t')), vdupq_n_u8(4));
+    const auto is_space = vreinterpretq_u16_u8(vorrq_u8(is_blank, is_control));
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(is_space, 4)), 0);
+}
+#endif
+
+/// Finds the first character in the range for which isspace() equals @p Space.
+template <bool Space>
+inline constexpr const char* find_space_or_not(const char* begin, const char* end) noexcept
+{
+    auto p = begin;
+    if (!is_constant_evaluated())
+    {
+#ifdef ZVMC_SIMD_AVX2
+        if (end - p >= 32 && has_avx2())
+        {
+            for (; end - p >= 32; p += 32)
+            {
+                const auto mask = space_mask_avx2(p) ^ (Space ? 0 : 0xffffffff);
+                if (mask != 0)
+                    return p + count_trailing_zeros(mask);
+            }
+        }
+#endif
+#ifdef ZVMC_SIMD_SSE2
+        for (; end - p >= 16; p += 16)
+        {
+            const auto mask = space_mask_sse2(p) ^ (Space ? 0 : 0xffff);
+            if (mask != 0)
+                return p + count_trailing_zeros(mask);
+        }
+#elif defined(ZVMC_SIMD_NEON)
+        for (; end - p >= 16; p += 16)
+        {
+            const auto mask = space_mask_neon(p) ^ (Space ? 0 : ~uint64_t{0});
+            if (mask != 0)
+                return p + count_trailing_zeros(mask) / 4;
+        }
+#endif
+    }
+    while (p != end && isspace(*p) != Space)
+        ++p;
+    return p;
+}
+}  // namespace internal
+
+/// Finds the first whitespace character in the contiguous range of characters.
+/// Returns the @p end if not found. The range is scanned in SIMD blocks where available.
+inline constexpr const char* find_space(const char* begin, const char* end) noexcept
+{
+    return internal::find_space_or_not<true>(begin, end);
+}
+
+/// Finds the first non-whitespace character in the contiguous range of characters.
+/// Returns the @p end if not found. The range is scanned in SIMD blocks where available.
+inline constexpr const char* find_not_space(const char* begin, const char* end) noexcept
+{
+    return internal::find_space_or_not<false>(begin, end);
+}
+
 /// The filter iterator adaptor creates a view of an iterator range in which some elements of the
 /// range are skipped. A predicate function controls which elements are skipped. When the predicate
 /// is applied to an element, if it returns true then the element is retained and if it returns
@@ -99,6 +268,57 @@ struct skip_space_iterator : filter_iterator<BaseIterator, is_not_space>
     using filter_iterator<BaseIterator, is_not_space>::filter_iterator;
 };
 
+/// The input iterator which skips whitespace characters from the contiguous range of characters.
+///
+/// The specialization of the skip_space_iterator for pointers to characters. The whitespace
+/// is skipped with find_not_space() instead of testing one character at a time.
+template <>
+struct skip_space_iterator<const char*>
+{
+    /// The iterator difference type.
+    using difference_type = std::ptrdiff_t;
+
+    /// The iterator value type.
+    using value_type = char;
+
+    /// The iterator pointer type.
+    using pointer = const char*;
+
+    /// The iterator reference type.
+    using reference = const char&;
+
+    /// The iterator category.
+    using iterator_category = std::input_iterator_tag;
+
+private:
+    const char* base;
+    const char* base_end;
+
+public:
+    /// The constructor of the base iterator pair.
+    constexpr skip_space_iterator(const char* it, const char* end) noexcept
+      : base{find_not_space(it, end)}, base_end{end}
+    {}
+
+    /// The dereference operator.
+    constexpr char operator*() const noexcept { return *base; }
+
+    /// The increment operator.
+    constexpr void operator++() noexcept { base = find_not_space(base + 1, base_end); }
+
+    /// The equality operator.
+    constexpr bool operator==(const skip_space_iterator& o) const noexcept
+    {
+        return base == o.base;
+    }
+
+    /// The inequality operator.
+    constexpr bool operator!=(const skip_space_iterator& o) const noexcept
+    {
+        return base != o.base;
+    }
+};
+
 /// Class template argument deduction guide.
 template <typename BaseIterator>
 skip_space_iterator(BaseIterator, BaseIterator) -> skip_space_iterator<BaseIterator>;
@@ -8,6 +8,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 
 namespace zvmc
 {
@@ -25,16 +26,6 @@ inline std::string hex(uint8_t b) noexcept
     return {hex_digits[b >> 4], hex_digits[b & 0xf]};
 }
 
-/// Encodes bytes as hex string.
-inline std::string hex(bytes_view bs)
-{
-    std::string str;
-    str.reserve(bs.size() * 2);
-    for (const auto b : bs)
-        str += hex(b);
-    return str;
-}
-
 namespace internal
 {
 /// Extracts the nibble value out of a hex digit.
@@ -50,8 +41,256 @@ inline constexpr int from_hex_digit(char h) noexcept
     else
         return -1;
 }
+
+/// Encodes the bytes as hex digits. Scalar implementation.
+inline char* encode_hex_scalar(const uint8_t* in, size_t size, char* out) noexcept
+{
+    static constexpr auto hex_digits = "0123456789abcdef";
+    for (size_t i = 0; i < size; ++i)
+    {
+        *out++ = hex_digits[in[i] >> 4];
+        *out++ = hex_digits[in[i] & 0xf];
+    }
+    return out;
+}
+
+/// Decodes the even number of hex digits. Scalar implementation.
+/// Returns false in case of an invalid hex digit.
+inline bool decode_hex_scalar(const char* in, size_t size, uint8_t* out) noexcept
+{
+    int invalid = 0;  // Accumulates the sign bits of invalid digits.
+    for (size_t i = 0; i < size; i += 2)
+    {
+        const int hi = from_hex_digit(in[i]);
+        const int lo = from_hex_digit(in[i + 1]);
+        invalid |= hi | lo;
+        // The invalid digits are shifted as unsigned, the output is discarded in this case.
+        *out++ = static_cast<uint8_t>((static_cast<unsigned>(hi) << 4) | static_cast<unsigned>(lo));
+    }
+    return invalid >= 0;
+}
+
+#ifdef ZVMC_SIMD_SSE2
+/// Converts nibble values to hex digits. SSE2 implementation.
+inline __m128i hex_digits_sse2(__m128i nibbles) noexcept
+{
+    const auto letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)),
+                                       _mm_set1_epi8('a' - '0' - 10));
+    return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+}
+
+/// Encodes 16 bytes as 32 hex digits. SSE2 implementation.
+inline void encode_hex_sse2(const uint8_t* in, char* out) noexcept
+{
+    const auto mask = _mm_set1_epi8(0x0f);
+    const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const auto hi = hex_digits_sse2(_mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    const auto lo = hex_digits_sse2(_mm_and_si128(v, mask));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(hi, lo));
+}
+
+/// Converts hex digits to nibble values and clears the @p valid lanes of invalid digits.
+/// SSE2 implementation.
+inline __m128i hex_nibbles_sse2(__m128i chars, __m128i& valid) noexcept
+{
+    const auto d = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+    const auto is_digit = _mm_and_si128(_mm_cmpgt_epi8(d, _mm_set1_epi8(-1)),
+                                        _mm_cmplt_epi8(d, _mm_set1_epi8(10)));
+    const auto l = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    const auto is_letter = _mm_and_si128(_mm_cmpgt_epi8(l, _mm_set1_epi8(-1)),
+                                         _mm_cmplt_epi8(l, _mm_set1_epi8(6)));
+    valid = _mm_and_si128(valid, _mm_or_si128(is_digit, is_letter));
+    return _mm_or_si128(_mm_and_si128(d, is_digit),
+                        _mm_and_si128(_mm_add_epi8(l, _mm_set1_epi8(10)), is_letter));
+}
+
+/// Combines the pairs of nibbles into bytes stored in 16-bit lanes. SSE2 implementation.
+inline __m128i hex_pairs_sse2(__m128i nibbles) noexcept
+{
+    const auto hi = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4);
+    return _mm_or_si128(hi, _mm_srli_epi16(nibbles, 8));
+}
+
+/// Decodes 32 hex digits to 16 bytes. SSE2 implementation.
+/// Returns false in case of an invalid hex digit.
+inline bool decode_hex_sse2(const char* in, uint8_t* out) noexcept
+{
+    auto valid = _mm_set1_epi8(-1);
+    const auto n0 =
+        hex_nibbles_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), valid);
+    const auto n1 =
+        hex_nibbles_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16)), valid);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                     _mm_packus_epi16(hex_pairs_sse2(n0), hex_pairs_sse2(n1)));
+    return _mm_movemask_epi8(valid) == 0xffff;
+}
+#endif
+
+#ifdef ZVMC_SIMD_AVX2
+/// Converts nibble values to hex digits. AVX2 implementation.
+ZVMC_TARGET_AVX2 inline __m256i hex_digits_avx2(__m256i nibbles) noexcept
+{
+    const auto letters = _mm256_and_si256(_mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9)),
+                                          _mm256_set1_epi8('a' - '0' - 10));
+    return _mm256_add_epi8(_mm256_add_epi8(nibbles, _mm256_set1_epi8('0')), letters);
+}
+
+/// Encodes 32 bytes as 64 hex digits. AVX2 implementation.
+ZVMC_TARGET_AVX2 inline void encode_hex_avx2(const uint8_t* in, char* out) noexcept
+{
+    const auto mask = _mm256_set1_epi8(0x0f);
+    const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in));
+    const auto hi = hex_digits_avx2(_mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+    const auto lo = hex_digits_avx2(_mm256_and_si256(v, mask));
+    // The unpack instructions work within 128-bit lanes, the lanes are reordered afterwards.
+    const auto a = _mm256_unpacklo_epi8(hi, lo);
+    const auto b = _mm256_unpackhi_epi8(hi, lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(a, b, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32),
+                        _mm256_permute2x128_si256(a, b, 0x31));
+}
+
+/// Converts hex digits to nibble values and clears the @p valid lanes of invalid digits.
+/// AVX2 implementation.
+ZVMC_TARGET_AVX2 inline __m256i hex_nibbles_avx2(__m256i chars, __m256i& valid) noexcept
+{
+    const auto d = _mm256_sub_epi8(chars, _mm256_set1_epi8('0'));
+    const auto is_digit = _mm256_andnot_si256(_mm256_cmpgt_epi8(_mm256_setzero_si256(), d),
+                                              _mm256_cmpgt_epi8(_mm256_set1_epi8(10), d));
+    const auto l =
+        _mm256_sub_epi8(_mm256_or_si256(chars, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    const auto is_letter = _mm256_andnot_si256(_mm256_cmpgt_epi8(_mm256_setzero_si256(), l),
+                                               _mm256_cmpgt_epi8(_mm256_set1_epi8(6), l));
+    valid = _mm256_and_si256(valid, _mm256_or_si256(is_digit, is_letter));
+    return _mm256_or_si256(_mm256_and_si256(d, is_digit),
+                           _mm256_and_si256(_mm256_add_epi8(l, _mm256_set1_epi8(10)), is_letter));
+}
+
+/// Combines the pairs of nibbles into bytes stored in 16-bit lanes. AVX2 implementation.
+ZVMC_TARGET_AVX2 inline __m256i hex_pairs_avx2(__m256i nibbles) noexcept
+{
+    const auto hi = _mm256_slli_epi16(_mm256_and_si256(nibbles, _mm256_set1_epi16(0x00ff)), 4);
+    return _mm256_or_si256(hi, _mm256_srli_epi16(nibbles, 8));
+}
+
+/// Decodes 64 hex digits to 32 bytes. AVX2 implementation.
+/// Returns false in case of an invalid hex digit.
+ZVMC_TARGET_AVX2 inline bool decode_hex_avx2(const char* in, uint8_t* out) noexcept
+{
+    auto valid = _mm256_set1_epi8(-1);
+    const auto n0 =
+        hex_nibbles_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in)), valid);
+    const auto n1 =
+        hex_nibbles_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + 32)), valid);
+    // The pack instruction works within 128-bit lanes, the 64-bit parts are reordered afterwards.
+    const auto packed = _mm256_packus_epi16(hex_pairs_avx2(n0), hex_pairs_avx2(n1));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+                        _mm256_permute4x64_epi64(packed, 0xd8));
+    return _mm256_movemask_epi8(valid) == -1;
+}
+#endif
+
+#ifdef ZVMC_SIMD_NEON
+/// Encodes 16 bytes as 32 hex digits. NEON implementation.
+inline void encode_hex_neon(const uint8_t* in, char* out) noexcept
+{
+    const auto digits = vld1q_u8(reinterpret_cast<const uint8_t*>("0123456789abcdef"));
+    const auto v = vld1q_u8(in);
+    uint8x16x2_t r;
+    r.val[0] = vqtbl1q_u8(digits, vshrq_n_u8(v, 4));
+    r.val[1] = vqtbl1q_u8(digits, vandq_u8(v, vdupq_n_u8(0x0f)));
+    vst2q_u8(reinterpret_cast<uint8_t*>(out), r);
+}
+
+/// Converts hex digits to nibble values and clears the @p valid lanes of invalid digits.
+/// NEON implementation.
+inline uint8x16_t hex_nibbles_neon(uint8x16_t chars, uint8x16_t& valid) noexcept
+{
+    const auto d = vsubq_u8(chars, vdupq_n_u8('0'));
+    const auto is_digit = vcltq_u8(d, vdupq_n_u8(10));
+    const auto l = vsubq_u8(vorrq_u8(chars, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    const auto is_letter = vcltq_u8(l, vdupq_n_u8(6));
+    valid = vandq_u8(valid, vorrq_u8(is_digit, is_letter));
+    return vbslq_u8(is_digit, d, vaddq_u8(l, vdupq_n_u8(10)));
+}
+
+/// Decodes 32 hex digits to 16 bytes. NEON implementation.
+/// Returns false in case of an invalid hex digit.
+inline bool decode_hex_neon(const char* in, uint8_t* out) noexcept
+{
+    auto valid = vdupq_n_u8(0xff);
+    const auto chars = vld2q_u8(reinterpret_cast<const uint8_t*>(in));  // Deinterleaves pairs.
+    const auto hi = hex_nibbles_neon(chars.val[0], valid);
+    const auto lo = hex_nibbles_neon(chars.val[1], valid);
+    vst1q_u8(out, vorrq_u8(vshlq_n_u8(hi, 4), lo));
+    return vminvq_u8(valid) == 0xff;
+}
+#endif
+
+/// Encodes the bytes as hex digits using the widest SIMD instructions supported by the CPU.
+/// Returns the pointer past the last written digit.
+inline char* encode_hex(const uint8_t* in, size_t size, char* out) noexcept
+{
+#ifdef ZVMC_SIMD_AVX2
+    if (size >= 32 && has_avx2())
+    {
+        for (; size >= 32; in += 32, size -= 32, out += 64)
+            encode_hex_avx2(in, out);
+    }
+#endif
+#ifdef ZVMC_SIMD_SSE2
+    for (; size >= 16; in += 16, size -= 16, out += 32)
+        encode_hex_sse2(in, out);
+#elif defined(ZVMC_SIMD_NEON)
+    for (; size >= 16; in += 16, size -= 16, out += 32)
+        encode_hex_neon(in, out);
+#endif
+    return encode_hex_scalar(in, size, out);
+}
+
+/// Decodes the even number of hex digits using the widest SIMD instructions supported by the CPU.
+/// Returns false in case of an invalid hex digit.
+inline bool decode_hex(const char* in, size_t size, uint8_t* out) noexcept
+{
+    bool valid = true;
+#ifdef ZVMC_SIMD_AVX2
+    if (size >= 64 && has_avx2())
+    {
+        for (; size >= 64; in += 64, size -= 64, out += 32)
+            valid &= decode_hex_avx2(in, out);
+    }
+#endif
+#ifdef ZVMC_SIMD_SSE2
+    for (; size >= 32; in += 32, size -= 32, out += 16)
+        valid &= decode_hex_sse2(in, out);
+#elif defined(ZVMC_SIMD_NEON)
+    for (; size >= 32; in += 32, size -= 32, out += 16)
+        valid &= decode_hex_neon(in, out);
+#endif
+    return decode_hex_scalar(in, size, out) && valid;
+}
 }  // namespace internal
 
+/// Encodes bytes as hex string into the provided buffer.
+///
+/// The buffer must have space for 2 * bs.size() characters. The terminating null character
+/// is not written.
+///
+/// @return  The pointer past the last written character.
+inline char* hex(bytes_view bs, char* out) noexcept
+{
+    return internal::encode_hex(bs.data(), bs.size(), out);
+}
+
+/// Encodes bytes as hex string.
+inline std::string hex(bytes_view bs)
+{
+    std::string str(bs.size() * 2, '\0');
+    hex(bs, str.data());
+    return str;
+}
+
 /// Decodes hex-encoded sequence of characters.
 ///
 /// It is guaranteed that the output will not be longer than half of the input length.
@@ -128,16 +367,32 @@ constexpr std::optional<T> from_prefixed_hex(std::string_view s, std::string_vie
 }
 
 
+/// Decodes hex encoded string into the provided buffer.
+///
+/// The optional 0x prefix is omitted. The buffer must have space for hex.size() / 2 bytes.
+///
+/// @return  The number of decoded bytes or std::nullopt in case the input is invalid.
+///          This can happen if a non-hex digit or odd number of digits is encountered.
+inline std::optional<size_t> from_hex(std::string_view hex, uint8_t* out) noexcept
+{
+    if (hex.size() >= 2 && hex[0] == '0' && hex[1] == 'x')
+        hex.remove_prefix(2);
+    if (hex.size() % 2 != 0 || !internal::decode_hex(hex.data(), hex.size(), out))
+        return {};
+    return hex.size() / 2;
+}
+
 /// Decodes hex encoded string to bytes.
 ///
 /// In case the input is invalid the returned value is std::nullopt.
 /// This can happen if a non-hex digit or odd number of digits is encountered.
 inline std::optional<bytes> from_hex(std::string_view hex)
 {
-    bytes bs;
-    bs.reserve(hex.size() / 2);
-    if (!from_hex(hex.begin(), hex.end(), std::back_inserter(bs)))
+    bytes bs(hex.size() / 2, 0);
+    const auto size = from_hex(hex, bs.data());
+    if (!size)
         return {};
+    bs.resize(*size);
     return bs;
 }
 
@@ -178,9 +433,152 @@ std::optional<bytes> from_spaced_hex(InputIterator begin, InputIterator end) noe
     return bs;
 }
 
+/// The incremental decoder of hex-encoded input split into chunks. The whitespace is ignored.
+///
+/// The chunks may be split at any position, including in the middle of a byte (the pending
+/// nibble is carried over to the next chunk) and the optional 0x prefix.
+/// The runs of hex digits between whitespace are decoded in bulk.
+class spaced_hex_decoder
+{
+    /// The value of the high nibble waiting for the low one, or -1 if none.
+    int m_pending = -1;
+
+    /// The number of non-space characters consumed so far (needed for the 0x prefix).
+    uint64_t m_num_chars = 0;
+
+    /// Whether an invalid character has been encountered.
+    bool m_invalid = false;
+
+    /// Consumes a single non-space character. Returns false if it is invalid.
+    bool consume(char c, uint8_t*& out) noexcept
+    {
+        const auto index = m_num_chars++;
+        if (index == 1 && m_pending == 0 && c == 'x')  // 0x prefix
+        {
+            m_pending = -1;
+            return true;
+        }
+
+        const int v = internal::from_hex_digit(c);
+        if (v < 0)
+            return false;
+        if (m_pending < 0)
+            m_pending = v;
+        else
+        {
+            *out++ = static_cast<uint8_t>((m_pending << 4) | v);
+            m_pending = -1;
+        }
+        return true;
+    }
+
+public:
+    /// The maximum number of bytes decoded from a chunk of the given size.
+    static constexpr size_t max_decoded_size(size_t chunk_size) noexcept
+    {
+        return (chunk_size + 1) / 2;
+    }
+
+    /// Decodes the next chunk of the input into the @p out buffer.
+    ///
+    /// The buffer must have space for max_decoded_size(chunk.size()) bytes.
+    ///
+    /// @return  The number of decoded bytes or std::nullopt in case of invalid input.
+    std::optional<size_t> decode(std::string_view chunk, uint8_t* out) noexcept
+    {
+        if (m_invalid)
+            return {};
+
+        const auto out_begin = out;
+        auto p = chunk.data();
+        const auto end = p + chunk.size();
+        while (p != end)
+        {
+            p = find_not_space(p, end);
+            const auto run_end = find_space(p, end);
+
+            // Handle the 0x prefix and the pending nibble one character at a time.
+            while (p != run_end && (m_num_chars < 2 || m_pending >= 0) && !m_invalid)
+                m_invalid = !consume(*p++, out);
+
+            // Decode the pairs of digits in bulk and leave the odd one pending.
+            const auto num_pairs = static_cast<size_t>(run_end - p) / 2;
+            m_invalid = m_invalid || !internal::decode_hex(p, 2 * num_pairs, out);
+            p += 2 * num_pairs;
+            out += num_pairs;
+            m_num_chars += 2 * num_pairs;
+
+            if (p != run_end && !m_invalid)
+                m_invalid = !consume(*p++, out);
+
+            if (m_invalid)
+                return {};
+        }
+        return static_cast<size_t>(out - out_begin);
+    }
+
+    /// Checks if the whole input consumed so far is valid hex (no nibble is left pending).
+    bool finish() const noexcept { return !m_invalid && m_pending < 0; }
+};
+
+/// Decodes hex-encoded input provided in chunks and passes the decoded bytes to the sink.
+///
+/// The memory usage is bounded by the chunk size, independently of the input size.
+/// The whitespace in the input is ignored.
+///
+/// @param read        The function `size_t(char* buffer, size_t size)` reading the next chunk
+///                    of the input into the buffer and returning the number of characters read.
+///                    The 0 indicates the end of the input.
+/// @param sink        The function `void(bytes_view)` receiving the decoded bytes.
+/// @param chunk_size  The size of the input chunks.
+/// @return            True if successful, false if the input is invalid hex.
+template <typename ReadFn, typename SinkFn>
+bool from_spaced_hex_chunks(ReadFn&& read, SinkFn&& sink, size_t chunk_size = 64 * 1024)
+{
+    std::string chunk(chunk_size, '\0');
+    bytes decoded(spaced_hex_decoder::max_decoded_size(chunk_size), 0);
+    spaced_hex_decoder decoder;
+    while (true)
+    {
+        const auto n = static_cast<size_t>(read(chunk.data(), chunk.size()));
+        if (n == 0)
+            break;
+        const auto decoded_size = decoder.decode({chunk.data(), n}, decoded.data());
+        if (!decoded_size)
+            return false;
+        if (*decoded_size != 0)
+            sink(bytes_view{decoded.data(), *decoded_size});
+    }
+    return decoder.finish();
+}
+
+/// Decodes hex-encoded input stream (e.g. std::istream) in chunks and passes the decoded bytes
+/// to the sink. The whitespace in the input is ignored.
+///
+/// @param in          The input stream.
+/// @param sink        The function `void(bytes_view)` receiving the decoded bytes.
+/// @param chunk_size  The size of the input chunks.
+/// @return            True if successful, false if the input is invalid hex.
+template <typename InputStream, typename SinkFn>
+bool from_spaced_hex_stream(InputStream& in, SinkFn&& sink, size_t chunk_size = 64 * 1024)
+{
+    return from_spaced_hex_chunks(
+        [&in](char* buffer, size_t size) {
+            in.read(buffer, static_cast<std::streamsize>(size));
+            return static_cast<size_t>(in.gcount());
+        },
+        std::forward<SinkFn>(sink), chunk_size);
+}
+
 /// @copydoc from_spaced_hex
 inline std::optional<bytes> from_spaced_hex(std::string_view hex) noexcept
 {
-    return from_spaced_hex(hex.begin(), hex.end());
+    bytes bs(spaced_hex_decoder::max_decoded_size(hex.size()), 0);
+    spaced_hex_decoder decoder;
+    const auto size = decoder.decode(hex, bs.data());
+    if (!size || !decoder.finish())
+        return {};
+    bs.resize(*size);
+    return bs;
 }
 }  // namespace zvmc
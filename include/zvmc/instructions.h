@@ -197,6 +197,71 @@ struct zvmc_instruction_metrics
     int8_t stack_height_change;
 };
 
+/**
+ * The flags of an ZVM 1 instruction, see zvmc_instruction_info.
+ */
+enum zvmc_instruction_flags
+{
+    /** The instruction is defined in the ZVM revision. */
+    ZVMC_INSTRUCTION_DEFINED = 1 << 0,
+
+    /** The instruction always ends the execution (STOP, RETURN, REVERT, INVALID). */
+    ZVMC_INSTRUCTION_TERMINATOR = 1 << 1,
+
+    /** The instruction may continue the execution at a jump destination (JUMP, JUMPI). */
+    ZVMC_INSTRUCTION_JUMP = 1 << 2,
+
+    /**
+     * The instruction ends a basic block: the terminators and the jumps.
+     *
+     * The undefined instructions also end basic blocks as they abort the execution,
+     * but they have no flags set.
+     */
+    ZVMC_INSTRUCTION_ENDS_BLOCK = 1 << 3,
+
+    /** The instruction may cost more than its static gas cost. */
+    ZVMC_INSTRUCTION_DYNAMIC_GAS = 1 << 4,
+
+    /** The instruction accesses the ZVM memory. */
+    ZVMC_INSTRUCTION_MEMORY = 1 << 5,
+
+    /** The instruction calls the Host. */
+    ZVMC_INSTRUCTION_HOST = 1 << 6,
+
+    /** The instruction reads the account state through the Host. */
+    ZVMC_INSTRUCTION_READS_STATE = 1 << 7,
+
+    /**
+     * The instruction may modify the state, so it is not allowed in static calls
+     * (CALL only with non-zero value).
+     */
+    ZVMC_INSTRUCTION_WRITES_STATE = 1 << 8
+};
+
+/**
+ * The extended metadata of an ZVM 1 instruction.
+ *
+ * The entry fits in 8 bytes, so an instruction is classified with a single load.
+ * The entries for undefined instructions are all zeros.
+ */
+struct zvmc_instruction_info
+{
+    /** The instruction gas cost, the same as in zvmc_instruction_metrics. */
+    int16_t gas_cost;
+
+    /** The minimum number of the ZVM stack items required for the instruction. */
+    int8_t stack_height_required;
+
+    /** The ZVM stack height change caused by the instruction execution. */
+    int8_t stack_height_change;
+
+    /** The number of the immediate bytes following the opcode in the code. */
+    uint8_t immediate_size;
+
+    /** The combination of the ::zvmc_instruction_flags. */
+    uint16_t flags;
+};
+
 /**
  * Get the table of the ZVM 1 instructions metrics.
  *
@@ -218,6 +283,16 @@ ZVMC_EXPORT const struct zvmc_instruction_metrics* zvmc_get_instruction_metrics_
  */
 ZVMC_EXPORT const char* const* zvmc_get_instruction_names_table(enum zvmc_revision revision);
 
+/**
+ * Get the table of the ZVM 1 instructions extended metadata.
+ *
+ * @param revision  The ZVM revision.
+ * @return          The pointer to the array of 256 instruction metadata entries. Null pointer
+ *                  in case an invalid ZVM revision provided.
+ */
+ZVMC_EXPORT const struct zvmc_instruction_info* zvmc_get_instruction_info_table(
+    enum zvmc_revision revision);
+
 #ifdef __cplusplus
 }
 #endif
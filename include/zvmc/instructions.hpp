@@ -0,0 +1,107 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+#pragma once
+
+#include <zvmc/instructions.h>
+
+#include <array>
+#include <cstdint>
+
+/// The compile-time traits of the ZVM instructions.
+///
+/// The traits come from the same list as the C tables of zvmc/instructions.h,
+/// so the C++ VMs can use them as template arguments without linking zvmc::instructions.
+namespace zvmc::instr
+{
+/// The instruction flags, see zvmc/instructions.def and ::zvmc_instruction_flags.
+enum Flags : uint16_t
+{
+    TERMINATOR = ZVMC_INSTRUCTION_TERMINATOR,
+    JUMP = ZVMC_INSTRUCTION_JUMP,
+    DYNAMIC_GAS = ZVMC_INSTRUCTION_DYNAMIC_GAS,
+    MEMORY = ZVMC_INSTRUCTION_MEMORY,
+    HOST = ZVMC_INSTRUCTION_HOST,
+    READS_STATE = ZVMC_INSTRUCTION_READS_STATE,
+    WRITES_STATE = ZVMC_INSTRUCTION_WRITES_STATE,
+};
+
+/// The traits of an instruction in a ZVM revision.
+struct Traits
+{
+    /// The instruction name or null if the instruction is undefined.
+    const char* name = nullptr;
+
+    /// The static gas cost, the same as in ::zvmc_instruction_metrics.
+    int16_t gas_cost = 0;
+
+    /// The minimum number of the stack items required for the instruction.
+    int8_t stack_height_required = 0;
+
+    /// The stack height change caused by the instruction execution.
+    int8_t stack_height_change = 0;
+
+    /// The number of the immediate bytes following the opcode in the code.
+    uint8_t immediate_size = 0;
+
+    /// The combination of the instruction Flags.
+    uint16_t flags = 0;
+
+    /// Checks if the instruction is defined in the revision.
+    constexpr bool is_defined() const noexcept { return name != nullptr; }
+
+    /// Checks if the instruction always ends the execution.
+    constexpr bool is_terminator() const noexcept { return (flags & TERMINATOR) != 0; }
+
+    /// Checks if the instruction may continue the execution at a jump destination.
+    constexpr bool is_jump() const noexcept { return (flags & JUMP) != 0; }
+
+    /// Checks if the instruction ends a basic block.
+    ///
+    /// These are the terminators, the jumps and the undefined instructions.
+    constexpr bool ends_block() const noexcept
+    {
+        return !is_defined() || (flags & (TERMINATOR | JUMP)) != 0;
+    }
+
+    /// Checks if the instruction may cost more than its static gas cost.
+    constexpr bool has_dynamic_gas() const noexcept { return (flags & DYNAMIC_GAS) != 0; }
+
+    /// Checks if the instruction accesses the ZVM memory.
+    constexpr bool accesses_memory() const noexcept { return (flags & MEMORY) != 0; }
+
+    /// Checks if the instruction calls the Host.
+    constexpr bool accesses_host() const noexcept { return (flags & HOST) != 0; }
+
+    /// Checks if the instruction reads the account state through the Host.
+    constexpr bool reads_state() const noexcept { return (flags & READS_STATE) != 0; }
+
+    /// Checks if the instruction may modify the state.
+    constexpr bool writes_state() const noexcept { return (flags & WRITES_STATE) != 0; }
+};
+
+/// Builds the table of the instruction traits of the revision.
+template <zvmc_revision Rev>
+constexpr std::array<Traits, 256> make_traits_table() noexcept
+{
+    static_assert(Rev == ZVMC_SHANGHAI, "unsupported ZVM revision");
+
+    std::array<Traits, 256> table{};
+#define ZVMC_INSTRUCTION(NAME, OPCODE, GAS_COST, STACK_REQUIRED, STACK_CHANGE, IMMEDIATE_SIZE, \
+                         FLAGS)                                                                \
+    table[OPCODE] = {#NAME, GAS_COST, STACK_REQUIRED, STACK_CHANGE, IMMEDIATE_SIZE, FLAGS};
+#include <zvmc/instructions.def>
+#undef ZVMC_INSTRUCTION
+    return table;
+}
+
+/// The table of the instruction traits of the revision.
+template <zvmc_revision Rev>
+inline constexpr std::array<Traits, 256> traits_table = make_traits_table<Rev>();
+
+/// The traits of the instruction in the revision.
+///
+/// This is a constant expression, e.g. `traits<ZVMC_SHANGHAI, OP_ADD>.gas_cost`.
+template <zvmc_revision Rev, uint8_t Opcode>
+inline constexpr Traits traits = traits_table<Rev>[Opcode];
+}  // namespace zvmc::instr
@@ -13,6 +13,10 @@
  */
 #pragma once
 
+#include <zvmc/zvmc.h>
+
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -78,11 +82,19 @@ enum zvmc_loader_error_code
  *   "zvmc_create_example_interpreter",
  * - if the function is not found, the function name "zvmc_create" is searched in the library.
  *
+ * If the `filename` has the "static:" prefix, the create function of the VM registered with
+ * zvmc_register_static_vm() is returned instead (see zvmc_find_static_vm()).
+ * The ::ZVMC_LOADER_CANNOT_OPEN error code is signaled if there is no VM with such name.
+ *
  * If the create function is found in the library, the pointer to the function is returned.
  * Otherwise, the ::ZVMC_LOADER_SYMBOL_NOT_FOUND error code is signaled and NULL is returned.
  *
- * It is safe to call this function with the same filename argument multiple times
- * (the DLL is not going to be loaded multiple times).
+ * Loaded modules are kept in the registry: the DLL is loaded and the create function is
+ * searched only once per module. Paths with a directory component are identified by
+ * their canonical absolute path, so different paths to the same file share the registry entry.
+ * Bare file names are identified by the name as given.
+ * Every successful call takes a reference to the module which can be returned with
+ * zvmc_release(). The registry is thread-safe.
  *
  * @param filename    The null terminated path (absolute or relative) to an ZVMC module
  *                    (dynamically loaded library) containing the VM implementation.
@@ -94,6 +106,86 @@ enum zvmc_loader_error_code
  */
 zvmc_create_fn zvmc_load(const char* filename, enum zvmc_loader_error_code* error_code);
 
+/**
+ * Releases the reference to the ZVMC module taken by zvmc_load().
+ *
+ * Also releases the reference taken by a successful zvmc_load_and_create(),
+ * zvmc_load_and_configure() or their variants. The destruction of a VM instance does not
+ * release any reference.
+ *
+ * When the last reference is released the module stays in the registry for future
+ * zvmc_load() calls, unless the @p unload is requested. In the latter case the DLL is closed:
+ * the unloading is only allowed when no VM instance created from this module is alive,
+ * and the create functions from this module MUST NOT be used anymore.
+ * The DLL is closed without the loader lock held, so the module destructors may call the loader.
+ *
+ * @param filename  The path to the ZVMC module, as passed to zvmc_load().
+ * @param unload    If not 0 the module is unloaded when no references are left.
+ * @return          The number of references left or -1 if the module is not loaded.
+ */
+int zvmc_release(const char* filename, int unload);
+
+/**
+ * Registers the VM linked statically into the program.
+ *
+ * The registered VM can be selected by the loader functions with the path
+ * "static:" + @p name, e.g. "static:example_vm". The create function is used directly,
+ * without any dynamic loading. The loader options of such paths have no effect.
+ * Up to 32 VMs can be registered. The registration is thread-safe.
+ *
+ * The VM registered by a dynamically loaded module MUST be unregistered with
+ * zvmc_unregister_static_vm() before the module is unloaded, e.g. in the module destructor
+ * (see ZVMC_REGISTER_STATIC_VM()).
+ *
+ * @param name       The null terminated name of the VM. The name is copied.
+ * @param create_fn  The VM create function.
+ * @return           1 if the VM has been registered, 0 if the arguments are invalid,
+ *                   the name is already registered or there is no space left.
+ */
+int zvmc_register_static_vm(const char* name, zvmc_create_fn create_fn);
+
+/**
+ * Finds the VM registered with zvmc_register_static_vm().
+ *
+ * @param name  The name of the VM, without the "static:" prefix.
+ * @return      The create function of the VM or NULL if the VM is not registered.
+ */
+zvmc_create_fn zvmc_find_static_vm(const char* name);
+
+/**
+ * Unregisters the VM registered with zvmc_register_static_vm().
+ *
+ * The VMs already created with the create function are not affected.
+ *
+ * @param name  The name of the VM, without the "static:" prefix.
+ * @return      1 if the VM has been unregistered, 0 if the VM is not registered.
+ */
+int zvmc_unregister_static_vm(const char* name);
+
+#if defined(__GNUC__) || defined(DOXYGEN)
+/**
+ * Registers the statically linked VM before the main() function starts.
+ *
+ * The VM is unregistered when the program exits or the module containing it is unloaded.
+ * The macro is used at file scope of a source file linked into the program, e.g.:
+ *
+ *     ZVMC_REGISTER_STATIC_VM("example_vm", zvmc_create_example_vm)
+ *
+ * Note that object files of static libraries are only linked in when they are referenced,
+ * so the macro should be placed in a source file of the program itself.
+ * Supported by GCC-compatible compilers, otherwise zvmc_register_static_vm() must be called.
+ */
+#define ZVMC_REGISTER_STATIC_VM(name, create_fn)                                        \
+    __attribute__((constructor)) static void zvmc_register_static_vm_##create_fn(void)  \
+    {                                                                                   \
+        zvmc_register_static_vm(name, create_fn);                                       \
+    }                                                                                   \
+    __attribute__((destructor)) static void zvmc_unregister_static_vm_##create_fn(void) \
+    {                                                                                   \
+        zvmc_unregister_static_vm(name);                                                \
+    }
+#endif
+
 /**
  * Dynamically loads the ZVMC module and creates the VM instance.
  *
@@ -105,7 +197,9 @@ zvmc_create_fn zvmc_load(const char* filename, enum zvmc_loader_error_code* erro
  *
  * It is safe to call this function with the same filename argument multiple times:
  * the DLL is not going to be loaded multiple times, but the function will return new VM instance
- * each time.
+ * each time. Every successful call takes a module reference which is not released by
+ * the destruction of the VM instance: call zvmc_release() once for every successful call,
+ * after the VM instance has been destroyed.
  *
  * @param filename    The null terminated path (absolute or relative) to an ZVMC module
  *                    (dynamically loaded library) containing the VM implementation.
@@ -127,7 +221,7 @@ struct zvmc_vm* zvmc_load_and_create(const char* filename, enum zvmc_loader_erro
  *
  * The configuration string (@p config) has the following syntax:
  *
- *     <path> ("," <option-name> ["=" <option-value>])*
+ *     <path> ("?" <loader-option> ["=" <value>])* ("," <option-name> ["=" <option-value>])*
  *
  * In this syntax, an option without a value can be specified (`,option,`)
  * as a shortcut for using empty value (`,option=,`).
@@ -135,15 +229,31 @@ struct zvmc_vm* zvmc_load_and_create(const char* filename, enum zvmc_loader_erro
  * Options are passed to a VM in the order they are specified in the configuration string.
  * It is up to the VM implementation how to handle duplicated options and other conflicts.
  *
+ * The loader options control how the ZVMC module is loaded:
+ * - `bind=now` resolves all symbols of the module when it is loaded (`RTLD_NOW`),
+ *   instead of on the first call (`bind=lazy`, the default),
+ * - `deepbind` makes the module prefer its own symbols over the global ones (`RTLD_DEEPBIND`),
+ *   only available where supported by the system,
+ * - `prefault` makes the code of the module resident in memory right after loading,
+ *   so the first executions do not page fault. On Linux, the kernel is also advised
+ *   to back the code with huge pages. On other systems this option has no effect.
+ *
+ * The loader options apply only when the module is loaded for the first time,
+ * see the registry in zvmc_load().
+ *
+ * As in zvmc_load_and_create(), every successful call takes a module reference which must be
+ * released with zvmc_release() of the module path once, after the VM instance has been destroyed.
+ *
  * Example configuration string:
  *
- *     ./modules/vm.so,engine=compiler,trace,verbosity=2
+ *     ./modules/vm.so?bind=now?prefault,engine=compiler,trace,verbosity=2
  *
  * The function signals the same errors as zvmc_load_and_create() and additionally:
  * - ::ZVMC_LOADER_INVALID_OPTION_NAME
- *   when the provided options list contains an option unknown for the VM,
+ *   when the provided options list contains an option unknown for the VM
+ *   or an unknown or unsupported loader option,
  * - ::ZVMC_LOADER_INVALID_OPTION_VALUE
- *   when there exists unsupported value for a given VM option.
+ *   when there exists unsupported value for a given VM option or loader option.
 
  *
  * @param config      The path to the ZVMC module with additional configuration options.
@@ -154,6 +264,152 @@ struct zvmc_vm* zvmc_load_and_create(const char* filename, enum zvmc_loader_erro
 struct zvmc_vm* zvmc_load_and_configure(const char* config,
                                         enum zvmc_loader_error_code* error_code);
 
+/**
+ * Reentrant variant of zvmc_load_and_configure() reporting the error message to the caller.
+ *
+ * Instead of keeping the error message to be retrieved with zvmc_last_error_msg(),
+ * the message is copied to the @p error_msg buffer. The message is truncated to fit the buffer
+ * and is always null-terminated. On success, or if no message is available, the buffer is set to
+ * an empty string.
+ *
+ * @param config          The path to the ZVMC module with additional configuration options.
+ * @param error_code      The pointer to the error code. If not NULL the value is set to
+ *                        ::ZVMC_LOADER_SUCCESS on success or any other error code
+ *                        as described in zvmc_load_and_configure().
+ * @param error_msg       The buffer for the error message. May be NULL.
+ * @param error_msg_size  The size of the @p error_msg buffer.
+ * @return                The pointer to the created VM or NULL in case of error.
+ */
+struct zvmc_vm* zvmc_load_and_configure_r(const char* config,
+                                          enum zvmc_loader_error_code* error_code,
+                                          char* error_msg,
+                                          size_t error_msg_size);
+
+/**
+ * The VM configuration parsed once to create and configure many VM instances.
+ *
+ * @see zvmc_parse_options()
+ */
+struct zvmc_option_set;
+
+/**
+ * Parses the VM configuration string into the option set.
+ *
+ * The configuration string has the syntax described in zvmc_load_and_configure().
+ * The syntax and the loader options are validated here, the VM options are validated by the VM
+ * when applied. The option set does not refer to the @p config string after this call.
+ * The configuration length is not limited.
+ *
+ * @param config      The path to the ZVMC module with additional configuration options.
+ * @param error_code  The pointer to the error code. If not NULL the value is set to
+ *                    ::ZVMC_LOADER_SUCCESS on success, ::ZVMC_LOADER_INVALID_ARGUMENT
+ *                    if @p config is NULL, or ::ZVMC_LOADER_INVALID_OPTION_NAME
+ *                    and ::ZVMC_LOADER_INVALID_OPTION_VALUE for invalid loader options.
+ * @return            The option set to be freed with zvmc_free_options()
+ *                    or NULL in case of error.
+ */
+struct zvmc_option_set* zvmc_parse_options(const char* config,
+                                           enum zvmc_loader_error_code* error_code);
+
+/**
+ * Frees the option set.
+ *
+ * @param options  The option set created by zvmc_parse_options(). May be NULL.
+ */
+void zvmc_free_options(struct zvmc_option_set* options);
+
+/**
+ * Returns the path of the ZVMC module of the option set, without the loader options.
+ */
+const char* zvmc_option_set_path(const struct zvmc_option_set* options);
+
+/**
+ * Applies the VM options of the option set to the VM instance.
+ *
+ * The options are set in the order they are specified in the configuration string.
+ * Applying stops at the first failure.
+ *
+ * @param options  The option set.
+ * @param vm       The VM instance to configure.
+ * @return         ::ZVMC_LOADER_SUCCESS, ::ZVMC_LOADER_INVALID_OPTION_NAME
+ *                 or ::ZVMC_LOADER_INVALID_OPTION_VALUE, as in zvmc_load_and_configure().
+ */
+enum zvmc_loader_error_code zvmc_apply_options(const struct zvmc_option_set* options,
+                                               struct zvmc_vm* vm);
+
+/**
+ * Loads the ZVMC module, then creates and configures the VM instance from the option set.
+ *
+ * This is equivalent to zvmc_load_and_configure() with the configuration string the option set
+ * has been parsed from, but the parsing is not repeated. Calling it for every VM instance is cheap:
+ * the module is loaded once (see zvmc_load()).
+ *
+ * @param options     The option set.
+ * @param error_code  The pointer to the error code. If not NULL the value is set to
+ *                    ::ZVMC_LOADER_SUCCESS on success or any other error code
+ *                    as described in zvmc_load_and_configure().
+ * @return            The pointer to the created VM or NULL in case of error.
+ */
+struct zvmc_vm* zvmc_create_with_options(const struct zvmc_option_set* options,
+                                         enum zvmc_loader_error_code* error_code);
+
+/**
+ * The warmup execution for VMs loaded by zvmc_load_many().
+ *
+ * The code is executed as a ::ZVMC_CALL message with the given input and gas limit
+ * in the Host with empty state where all calls fail. The execution results are ignored.
+ */
+struct zvmc_warmup
+{
+    /** The revision to execute the code in. */
+    enum zvmc_revision revision;
+
+    /** The code to execute. */
+    const uint8_t* code;
+
+    /** The code size. */
+    size_t code_size;
+
+    /** The message input data. May be NULL if input_size is 0. */
+    const uint8_t* input;
+
+    /** The message input data size. */
+    size_t input_size;
+
+    /** The message gas limit. */
+    int64_t gas;
+
+    /** The number of executions of the code for every VM. */
+    int iterations;
+};
+
+/**
+ * Loads, creates and configures multiple VM instances in parallel.
+ *
+ * Each configuration string is handled as by zvmc_load_and_configure() by a pool of worker
+ * threads, not more than the number of available CPUs.
+ * Then, if @p warmup is provided, each VM instance executes the warmup code in the same thread.
+ * This moves the costs of lazy symbol binding and page faults of the first executions
+ * from the first real requests to the start-up.
+ *
+ * If any VM fails to load, the error message of the first failed one is available
+ * with zvmc_last_error_msg().
+ *
+ * @param configs      The array of @p count configuration strings,
+ *                     see zvmc_load_and_configure().
+ * @param count        The number of configurations.
+ * @param warmup       The warmup execution. May be NULL.
+ * @param vms          The output array of @p count created VM instances. The VM instance is set
+ *                     to NULL if the corresponding configuration failed to load.
+ * @param error_codes  The output array of @p count error codes. May be NULL.
+ * @return             The number of successfully created VM instances.
+ */
+size_t zvmc_load_many(const char* const* configs,
+                      size_t count,
+                      const struct zvmc_warmup* warmup,
+                      struct zvmc_vm** vms,
+                      enum zvmc_loader_error_code* error_codes);
+
 /**
  * Returns the human-readable message describing the most recent error
  * that occurred in ZVMC loading since the last call to this function.
@@ -162,7 +418,7 @@ struct zvmc_vm* zvmc_load_and_configure(const char* config,
  * In case of error code other than success returned, this function MAY return the error message.
  * Calling this function "consumes" the error message and the function will return NULL
  * from subsequent invocations.
- * This function is not thread-safe.
+ * The error message is kept per thread: only errors of the calling thread are reported.
  *
  * @return Error message or NULL if no additional information is available.
  *         The returned pointer MUST NOT be freed by the caller.
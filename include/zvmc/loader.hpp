@@ -0,0 +1,106 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+#pragma once
+
+#include <zvmc/loader.h>
+#include <zvmc/zvmc.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace zvmc
+{
+/// The VM configuration parsed once to create and configure many VM instances.
+///
+/// This is the RAII wrapper for ::zvmc_option_set.
+class OptionSet
+{
+    std::unique_ptr<zvmc_option_set, decltype(&zvmc_free_options)> m_options;
+
+public:
+    /// Parses the configuration string, see zvmc_parse_options().
+    ///
+    /// In case of error the option set is empty and the error message is available with
+    /// zvmc_last_error_msg().
+    explicit OptionSet(const std::string& config,
+                       zvmc_loader_error_code* error_code = nullptr) noexcept
+      : m_options{zvmc_parse_options(config.c_str(), error_code), zvmc_free_options}
+    {}
+
+    /// Checks if the configuration has been parsed successfully.
+    explicit operator bool() const noexcept { return m_options != nullptr; }
+
+    /// The path of the ZVMC module, without the loader options.
+    const char* path() const noexcept { return zvmc_option_set_path(m_options.get()); }
+
+    /// Creates and configures the VM instance, see zvmc_create_with_options().
+    ///
+    /// The option set must not be empty.
+    VM create(zvmc_loader_error_code* error_code = nullptr) const noexcept
+    {
+        return VM{zvmc_create_with_options(m_options.get(), error_code)};
+    }
+
+    /// Applies the VM options to the VM instance, see zvmc_apply_options().
+    ///
+    /// The option set must not be empty.
+    zvmc_loader_error_code apply(VM& vm) const noexcept
+    {
+        return zvmc_apply_options(m_options.get(), vm.get_raw_pointer());
+    }
+
+    /// Returns the pointer to the C option set.
+    const zvmc_option_set* get_raw_pointer() const noexcept { return m_options.get(); }
+};
+
+/// Loads, creates and configures multiple VM instances in parallel.
+///
+/// This is a wrapper for zvmc_load_many(). A VM which failed to load is returned as an empty VM
+/// object. The error message of the first failure is available with zvmc_last_error_msg().
+///
+/// @param configs      The VM configuration strings, see zvmc_load_and_configure().
+/// @param warmup       The warmup execution to run on every VM. May be null.
+/// @param error_codes  The optional output for the error codes of the configurations.
+/// @return             The VM objects in the order of the configurations.
+inline std::vector<VM> load_many(const std::vector<std::string>& configs,
+                                 const zvmc_warmup* warmup = nullptr,
+                                 std::vector<zvmc_loader_error_code>* error_codes = nullptr)
+{
+    std::vector<const char*> c_configs;
+    c_configs.reserve(configs.size());
+    for (const auto& config : configs)
+        c_configs.push_back(config.c_str());
+
+    std::vector<zvmc_vm*> c_vms(configs.size());
+    if (error_codes != nullptr)
+        error_codes->resize(configs.size());
+    zvmc_load_many(c_configs.data(), c_configs.size(), warmup, c_vms.data(),
+                   error_codes != nullptr ? error_codes->data() : nullptr);
+
+    std::vector<VM> vms;
+    vms.reserve(c_vms.size());
+    for (auto* vm : c_vms)
+        vms.emplace_back(vm);
+    return vms;
+}
+
+/// Loads multiple VM instances in parallel and warms them up by executing the given code.
+///
+/// @param configs     The VM configuration strings, see zvmc_load_and_configure().
+/// @param rev         The revision to execute the warmup code in.
+/// @param code        The warmup code, executed with empty input and the empty state.
+/// @param gas         The gas limit of the warmup executions.
+/// @param iterations  The number of the warmup executions for every VM.
+/// @return            The VM objects in the order of the configurations.
+inline std::vector<VM> load_many(const std::vector<std::string>& configs,
+                                 zvmc_revision rev,
+                                 bytes_view code,
+                                 int64_t gas,
+                                 int iterations = 1)
+{
+    const zvmc_warmup warmup{rev, code.data(), code.size(), nullptr, 0, gas, iterations};
+    return load_many(configs, &warmup);
+}
+}  // namespace zvmc
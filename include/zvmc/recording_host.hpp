@@ -0,0 +1,630 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+#pragma once
+
+#include <zvmc/hex.hpp>
+#include <zvmc/zvmc.hpp>
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <vector>
+
+/// @file
+/// The Host wrappers recording the Host calls to a binary stream and replaying them back.
+///
+/// The record stream starts with the header "ZVMH" followed by the format version byte.
+/// Then every Host call is appended as a record: the HostCall kind byte, the call arguments
+/// and the call result. Integers are encoded as 8-byte little-endian, addresses and 32-byte
+/// words as raw bytes and byte strings as the 8-byte length followed by the bytes.
+/// The same encoding is used by the execution traces (see trace.hpp), with their own header.
+
+namespace zvmc
+{
+/// The kinds of the records of Host calls.
+enum class HostCall : uint8_t
+{
+    account_exists = 1,
+    get_storage = 2,
+    set_storage = 3,
+    get_balance = 4,
+    get_code_size = 5,
+    get_code_hash = 6,
+    copy_code = 7,
+    call = 8,
+    get_tx_context = 9,
+    get_block_hash = 10,
+    emit_log = 11,
+    access_account = 12,
+    access_storage = 13,
+};
+
+namespace host_record
+{
+/// The header of the record stream.
+constexpr uint8_t header[] = {'Z', 'V', 'M', 'H', 1};
+
+/// The buffered writer of the Host call records.
+class Writer
+{
+    std::ostream& m_out;
+    std::vector<uint8_t> m_buffer;
+    size_t m_size = 0;
+
+public:
+    /// The default size of the buffer.
+    static constexpr size_t default_buffer_size = 64 * 1024;
+
+    /// Constructs the writer to the @p out stream and writes the stream header.
+    explicit Writer(std::ostream& out,
+                    size_t buffer_size = default_buffer_size,
+                    bytes_view stream_header = {header, sizeof(header)})
+      : m_out{out}, m_buffer(buffer_size)
+    {
+        raw(stream_header.data(), stream_header.size());
+    }
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    ~Writer() noexcept { flush(); }
+
+    /// Writes the buffered records to the output stream.
+    void flush() noexcept
+    {
+        m_out.write(reinterpret_cast<const char*>(m_buffer.data()),
+                    static_cast<std::streamsize>(m_size));
+        m_out.flush();
+        m_size = 0;
+    }
+
+    /// Appends raw bytes.
+    void raw(const uint8_t* data, size_t size) noexcept
+    {
+        if (m_size + size > m_buffer.size())
+        {
+            flush();
+            if (size > m_buffer.size())
+            {
+                m_out.write(reinterpret_cast<const char*>(data),
+                            static_cast<std::streamsize>(size));
+                return;
+            }
+        }
+        if (size != 0)  // The data can be null for empty inputs.
+            std::memcpy(&m_buffer[m_size], data, size);
+        m_size += size;
+    }
+
+    /// Appends the record kind.
+    void kind(HostCall k) noexcept { raw(reinterpret_cast<const uint8_t*>(&k), 1); }
+
+    /// Appends an integer.
+    void integer(uint64_t v) noexcept
+    {
+        uint8_t b[8];
+        for (size_t i = 0; i < sizeof(b); ++i)
+            b[i] = static_cast<uint8_t>(v >> (8 * i));
+        raw(b, sizeof(b));
+    }
+
+    /// Appends an address or a 32-byte word.
+    template <typename T>
+    void word(const T& v) noexcept
+    {
+        raw(v.bytes, sizeof(v.bytes));
+    }
+
+    /// Appends a byte string.
+    void data(const uint8_t* d, size_t size) noexcept
+    {
+        integer(size);
+        raw(d, size);
+    }
+
+    /// Appends a message.
+    void message(const zvmc_message& msg) noexcept
+    {
+        integer(static_cast<uint64_t>(msg.kind));
+        integer(msg.flags);
+        integer(static_cast<uint64_t>(msg.depth));
+        integer(static_cast<uint64_t>(msg.gas));
+        word(msg.recipient);
+        word(msg.sender);
+        data(msg.input_data, msg.input_size);
+        word(msg.value);
+        word(msg.create2_salt);
+        word(msg.code_address);
+    }
+
+    /// Appends an execution result.
+    void result(const zvmc_result& r) noexcept
+    {
+        integer(static_cast<uint64_t>(r.status_code));
+        integer(static_cast<uint64_t>(r.gas_left));
+        integer(static_cast<uint64_t>(r.gas_refund));
+        data(r.output_data, r.output_size);
+        word(r.create_address);
+    }
+};
+
+/// The reader of the Host call records from the memory buffer.
+///
+/// Reading past the end of the buffer produces zero values and sets the error flag.
+class Reader
+{
+    bytes_view m_data;
+    bytes_view m_header;
+    size_t m_pos = 0;
+    bool m_error = false;
+
+public:
+    /// Constructs the reader of the records in the @p data (including the stream header).
+    explicit Reader(bytes_view data, bytes_view stream_header = {header, sizeof(header)}) noexcept
+      : m_data{data}, m_header{stream_header}
+    {
+        rewind();
+    }
+
+    /// Restarts reading from the first record.
+    void rewind() noexcept
+    {
+        m_pos = 0;
+        m_error = m_data.substr(0, m_header.size()) != m_header;
+        m_pos = m_error ? m_data.size() : m_header.size();
+    }
+
+    /// Whether there was an error: invalid header or reading past the end.
+    bool error() const noexcept { return m_error; }
+
+    /// Whether all the records have been read.
+    bool at_end() const noexcept { return m_pos == m_data.size(); }
+
+    /// The number of the bytes left to read.
+    size_t remaining() const noexcept { return m_data.size() - m_pos; }
+
+    /// Reads the given number of raw bytes. Returns the pointer to the bytes in the buffer.
+    const uint8_t* raw(size_t size) noexcept
+    {
+        static constexpr uint8_t zeros[32] = {};
+        if (m_error || size > m_data.size() - m_pos)
+        {
+            m_error = true;
+            m_pos = m_data.size();
+            return zeros;
+        }
+        const auto p = &m_data[m_pos];
+        m_pos += size;
+        return p;
+    }
+
+    /// Reads the record kind.
+    HostCall kind() noexcept { return static_cast<HostCall>(*raw(1)); }
+
+    /// Reads an integer.
+    uint64_t integer() noexcept
+    {
+        const auto b = raw(8);
+        uint64_t v = 0;
+        for (size_t i = 0; i < 8; ++i)
+            v |= uint64_t{b[i]} << (8 * i);
+        return v;
+    }
+
+    /// Reads an address or a 32-byte word.
+    template <typename T>
+    T word() noexcept
+    {
+        T v;
+        std::memcpy(v.bytes, raw(sizeof(v.bytes)), sizeof(v.bytes));
+        return v;
+    }
+
+    /// Reads a byte string. The returned view points into the buffer.
+    bytes_view data() noexcept
+    {
+        const auto size = integer();
+        if (size > m_data.size() - m_pos)
+        {
+            m_error = true;
+            m_pos = m_data.size();
+            return {};
+        }
+        return {raw(size), static_cast<size_t>(size)};
+    }
+
+    /// Reads a message. The input data points into the buffer.
+    zvmc_message message() noexcept
+    {
+        zvmc_message msg{};
+        msg.kind = static_cast<zvmc_call_kind>(integer());
+        msg.flags = static_cast<uint32_t>(integer());
+        msg.depth = static_cast<int32_t>(integer());
+        msg.gas = static_cast<int64_t>(integer());
+        msg.recipient = word<address>();
+        msg.sender = word<address>();
+        const auto input = data();
+        msg.input_data = input.data();
+        msg.input_size = input.size();
+        msg.value = word<uint256be>();
+        msg.create2_salt = word<bytes32>();
+        msg.code_address = word<address>();
+        return msg;
+    }
+
+    /// Reads an execution result. The output data points into the buffer and the result
+    /// has no release function.
+    zvmc_result result() noexcept
+    {
+        zvmc_result r{};
+        r.status_code = static_cast<zvmc_status_code>(integer());
+        r.gas_left = static_cast<int64_t>(integer());
+        r.gas_refund = static_cast<int64_t>(integer());
+        const auto output = data();
+        r.output_data = output.data();
+        r.output_size = output.size();
+        r.create_address = word<address>();
+        return r;
+    }
+};
+}  // namespace host_record
+
+/// The Host wrapper forwarding all calls to the wrapped Host and recording them
+/// (the arguments and the results) to the output stream.
+///
+/// The HostT is the type of the wrapped Host, e.g. zvmc::HostInterface or a concrete Host
+/// implementation (allowing the forwarding calls to be devirtualized).
+/// The records are buffered and written to the stream when the buffer is full,
+/// on flush() and on destruction.
+template <typename HostT>
+class RecordingHost : public Host
+{
+    HostT& m_host;
+    mutable host_record::Writer m_writer;
+
+public:
+    /// Constructs the recording wrapper of the @p host writing the records to the @p out.
+    RecordingHost(HostT& host,
+                  std::ostream& out,
+                  size_t buffer_size = host_record::Writer::default_buffer_size)
+      : m_host{host}, m_writer{out, buffer_size}
+    {}
+
+    /// Writes the buffered records to the output stream.
+    void flush() noexcept { m_writer.flush(); }
+
+    bool account_exists(const address& addr) const noexcept final
+    {
+        const auto result = m_host.account_exists(addr);
+        m_writer.kind(HostCall::account_exists);
+        m_writer.word(addr);
+        m_writer.integer(result);
+        return result;
+    }
+
+    bytes32 get_storage(const address& addr, const bytes32& key) const noexcept final
+    {
+        const auto result = m_host.get_storage(addr, key);
+        m_writer.kind(HostCall::get_storage);
+        m_writer.word(addr);
+        m_writer.word(key);
+        m_writer.word(result);
+        return result;
+    }
+
+    zvmc_storage_status set_storage(const address& addr,
+                                    const bytes32& key,
+                                    const bytes32& value) noexcept final
+    {
+        const auto result = m_host.set_storage(addr, key, value);
+        m_writer.kind(HostCall::set_storage);
+        m_writer.word(addr);
+        m_writer.word(key);
+        m_writer.word(value);
+        m_writer.integer(static_cast<uint64_t>(result));
+        return result;
+    }
+
+    uint256be get_balance(const address& addr) const noexcept final
+    {
+        const auto result = m_host.get_balance(addr);
+        m_writer.kind(HostCall::get_balance);
+        m_writer.word(addr);
+        m_writer.word(result);
+        return result;
+    }
+
+    size_t get_code_size(const address& addr) const noexcept final
+    {
+        const auto result = m_host.get_code_size(addr);
+        m_writer.kind(HostCall::get_code_size);
+        m_writer.word(addr);
+        m_writer.integer(result);
+        return result;
+    }
+
+    bytes32 get_code_hash(const address& addr) const noexcept final
+    {
+        const auto result = m_host.get_code_hash(addr);
+        m_writer.kind(HostCall::get_code_hash);
+        m_writer.word(addr);
+        m_writer.word(result);
+        return result;
+    }
+
+    size_t copy_code(const address& addr,
+                     size_t code_offset,
+                     uint8_t* buffer_data,
+                     size_t buffer_size) const noexcept final
+    {
+        const auto result = m_host.copy_code(addr, code_offset, buffer_data, buffer_size);
+        m_writer.kind(HostCall::copy_code);
+        m_writer.word(addr);
+        m_writer.integer(code_offset);
+        m_writer.integer(buffer_size);
+        m_writer.data(buffer_data, result);
+        return result;
+    }
+
+    Result call(const zvmc_message& msg) noexcept final
+    {
+        auto result = m_host.call(msg);
+        m_writer.kind(HostCall::call);
+        m_writer.message(msg);
+        m_writer.result(result.raw());
+        return result;
+    }
+
+    zvmc_tx_context get_tx_context() const noexcept final
+    {
+        const auto result = m_host.get_tx_context();
+        m_writer.kind(HostCall::get_tx_context);
+        m_writer.word(result.tx_gas_price);
+        m_writer.word(result.tx_origin);
+        m_writer.word(result.block_coinbase);
+        m_writer.integer(static_cast<uint64_t>(result.block_number));
+        m_writer.integer(static_cast<uint64_t>(result.block_timestamp));
+        m_writer.integer(static_cast<uint64_t>(result.block_gas_limit));
+        m_writer.word(result.block_prev_randao);
+        m_writer.word(result.chain_id);
+        m_writer.word(result.block_base_fee);
+        return result;
+    }
+
+    bytes32 get_block_hash(int64_t block_number) const noexcept final
+    {
+        const auto result = m_host.get_block_hash(block_number);
+        m_writer.kind(HostCall::get_block_hash);
+        m_writer.integer(static_cast<uint64_t>(block_number));
+        m_writer.word(result);
+        return result;
+    }
+
+    void emit_log(const address& addr,
+                  const uint8_t* data,
+                  size_t data_size,
+                  const bytes32 topics[],
+                  size_t num_topics) noexcept final
+    {
+        m_host.emit_log(addr, data, data_size, topics, num_topics);
+        m_writer.kind(HostCall::emit_log);
+        m_writer.word(addr);
+        m_writer.data(data, data_size);
+        m_writer.integer(num_topics);
+        for (size_t i = 0; i < num_topics; ++i)
+            m_writer.word(topics[i]);
+    }
+
+    zvmc_access_status access_account(const address& addr) noexcept final
+    {
+        const auto result = m_host.access_account(addr);
+        m_writer.kind(HostCall::access_account);
+        m_writer.word(addr);
+        m_writer.integer(static_cast<uint64_t>(result));
+        return result;
+    }
+
+    zvmc_access_status access_storage(const address& addr, const bytes32& key) noexcept final
+    {
+        const auto result = m_host.access_storage(addr, key);
+        m_writer.kind(HostCall::access_storage);
+        m_writer.word(addr);
+        m_writer.word(key);
+        m_writer.integer(static_cast<uint64_t>(result));
+        return result;
+    }
+};
+
+/// The Host serving the Host call results recorded by the RecordingHost.
+///
+/// The Host calls must be requested in the same order and with the same arguments
+/// as during the recording. Otherwise, the replay diverges: the diverged() flag is set
+/// and all following calls return zero values. The rewind() allows replaying
+/// the same record repeatedly, e.g. in benchmark loops.
+class ReplayHost : public Host
+{
+    bytes m_record;
+    mutable host_record::Reader m_reader;
+    mutable bool m_diverged = false;
+
+    /// Starts replaying a call. Returns false if the replay has diverged.
+    bool begin(HostCall kind) const noexcept
+    {
+        return !diverged() && check(m_reader.kind() == kind);
+    }
+
+    /// Checks if the recorded call argument matches the actual one.
+    bool check(bool match) const noexcept
+    {
+        m_diverged = m_diverged || !match;
+        return !diverged();
+    }
+
+public:
+    /// Constructs the replay Host from the record (as written by the RecordingHost).
+    explicit ReplayHost(bytes record) noexcept
+      : m_record{std::move(record)}, m_reader{m_record}
+    {}
+
+    /// Constructs the replay Host from the record read from the input stream.
+    explicit ReplayHost(std::istream& in)
+      : ReplayHost{bytes(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{})}
+    {}
+
+    ReplayHost(const ReplayHost&) = delete;
+    ReplayHost& operator=(const ReplayHost&) = delete;
+
+    /// Whether the requested Host calls did not match the record.
+    bool diverged() const noexcept { return m_diverged || m_reader.error(); }
+
+    /// Whether all the recorded calls have been replayed.
+    bool finished() const noexcept { return !diverged() && m_reader.at_end(); }
+
+    /// Restarts the replay from the first recorded call.
+    void rewind() noexcept
+    {
+        m_reader.rewind();
+        m_diverged = false;
+    }
+
+    bool account_exists(const address& addr) const noexcept final
+    {
+        if (!begin(HostCall::account_exists) || !check(m_reader.word<address>() == addr))
+            return false;
+        return m_reader.integer() != 0;
+    }
+
+    bytes32 get_storage(const address& addr, const bytes32& key) const noexcept final
+    {
+        if (!begin(HostCall::get_storage) || !check(m_reader.word<address>() == addr) ||
+            !check(m_reader.word<bytes32>() == key))
+            return {};
+        return m_reader.word<bytes32>();
+    }
+
+    zvmc_storage_status set_storage(const address& addr,
+                                    const bytes32& key,
+                                    const bytes32& value) noexcept final
+    {
+        if (!begin(HostCall::set_storage) || !check(m_reader.word<address>() == addr) ||
+            !check(m_reader.word<bytes32>() == key) || !check(m_reader.word<bytes32>() == value))
+            return ZVMC_STORAGE_ASSIGNED;
+        return static_cast<zvmc_storage_status>(m_reader.integer());
+    }
+
+    uint256be get_balance(const address& addr) const noexcept final
+    {
+        if (!begin(HostCall::get_balance) || !check(m_reader.word<address>() == addr))
+            return {};
+        return m_reader.word<uint256be>();
+    }
+
+    size_t get_code_size(const address& addr) const noexcept final
+    {
+        if (!begin(HostCall::get_code_size) || !check(m_reader.word<address>() == addr))
+            return 0;
+        return static_cast<size_t>(m_reader.integer());
+    }
+
+    bytes32 get_code_hash(const address& addr) const noexcept final
+    {
+        if (!begin(HostCall::get_code_hash) || !check(m_reader.word<address>() == addr))
+            return {};
+        return m_reader.word<bytes32>();
+    }
+
+    size_t copy_code(const address& addr,
+                     size_t code_offset,
+                     uint8_t* buffer_data,
+                     size_t buffer_size) const noexcept final
+    {
+        if (!begin(HostCall::copy_code) || !check(m_reader.word<address>() == addr) ||
+            !check(m_reader.integer() == code_offset) || !check(m_reader.integer() == buffer_size))
+            return 0;
+        const auto code = m_reader.data();
+        if (!check(code.size() <= buffer_size))
+            return 0;
+        std::copy(code.begin(), code.end(), buffer_data);
+        return code.size();
+    }
+
+    Result call(const zvmc_message& msg) noexcept final
+    {
+        if (!begin(HostCall::call))
+            return Result{ZVMC_INTERNAL_ERROR};
+        const auto m = m_reader.message();
+        if (!check(m.kind == msg.kind && m.flags == msg.flags && m.depth == msg.depth &&
+                   m.gas == msg.gas && address{m.recipient} == msg.recipient &&
+                   address{m.sender} == msg.sender &&
+                   bytes_view{m.input_data, m.input_size} ==
+                       bytes_view{msg.input_data, msg.input_size} &&
+                   uint256be{m.value} == msg.value && bytes32{m.create2_salt} == msg.create2_salt &&
+                   address{m.code_address} == msg.code_address))
+            return Result{ZVMC_INTERNAL_ERROR};
+
+        const auto r = m_reader.result();
+        Result result{r.status_code, r.gas_left, r.gas_refund, r.output_data, r.output_size};
+        result.create_address = r.create_address;
+        return result;
+    }
+
+    zvmc_tx_context get_tx_context() const noexcept final
+    {
+        zvmc_tx_context result{};
+        if (!begin(HostCall::get_tx_context))
+            return result;
+        result.tx_gas_price = m_reader.word<uint256be>();
+        result.tx_origin = m_reader.word<address>();
+        result.block_coinbase = m_reader.word<address>();
+        result.block_number = static_cast<int64_t>(m_reader.integer());
+        result.block_timestamp = static_cast<int64_t>(m_reader.integer());
+        result.block_gas_limit = static_cast<int64_t>(m_reader.integer());
+        result.block_prev_randao = m_reader.word<uint256be>();
+        result.chain_id = m_reader.word<uint256be>();
+        result.block_base_fee = m_reader.word<uint256be>();
+        return result;
+    }
+
+    bytes32 get_block_hash(int64_t block_number) const noexcept final
+    {
+        if (!begin(HostCall::get_block_hash) ||
+            !check(m_reader.integer() == static_cast<uint64_t>(block_number)))
+            return {};
+        return m_reader.word<bytes32>();
+    }
+
+    void emit_log(const address& addr,
+                  const uint8_t* data,
+                  size_t data_size,
+                  const bytes32 topics[],
+                  size_t num_topics) noexcept final
+    {
+        if (!begin(HostCall::emit_log) || !check(m_reader.word<address>() == addr) ||
+            !check(m_reader.data() == bytes_view{data, data_size}) ||
+            !check(m_reader.integer() == num_topics))
+            return;
+        for (size_t i = 0; i < num_topics; ++i)
+        {
+            if (!check(m_reader.word<bytes32>() == topics[i]))
+                return;
+        }
+    }
+
+    zvmc_access_status access_account(const address& addr) noexcept final
+    {
+        if (!begin(HostCall::access_account) || !check(m_reader.word<address>() == addr))
+            return ZVMC_ACCESS_COLD;
+        return static_cast<zvmc_access_status>(m_reader.integer());
+    }
+
+    zvmc_access_status access_storage(const address& addr, const bytes32& key) noexcept final
+    {
+        if (!begin(HostCall::access_storage) || !check(m_reader.word<address>() == addr) ||
+            !check(m_reader.word<bytes32>() == key))
+            return ZVMC_ACCESS_COLD;
+        return static_cast<zvmc_access_status>(m_reader.integer());
+    }
+};
+}  // namespace zvmc
@@ -1,13 +1,56 @@
 // EVMC: Ethereum Client-VM Connector API.
 // Copyright 2020 The EVMC Authors.
 // Licensed under the Apache License, Version 2.0.
+#pragma once
 
+#include <zvmc/hex.hpp>
 #include <zvmc/zvmc.hpp>
+#include <chrono>
 #include <iosfwd>
 #include <string>
 
+namespace zvmc
+{
+struct Trace;
+}
+
 namespace zvmc::tooling
 {
+/// The read-only contents of a file.
+///
+/// On POSIX systems the file is memory-mapped so the contents are not copied,
+/// elsewhere the contents are read into a buffer.
+class MappedFile
+{
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bytes m_buffer;
+
+public:
+    /// Creates the empty file view.
+    MappedFile() noexcept = default;
+
+    /// Maps the file at the @p path.
+    ///
+    /// @throws std::invalid_argument  In case the file cannot be opened or mapped.
+    explicit MappedFile(const std::string& path);
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    ~MappedFile() noexcept;
+
+    /// The file contents.
+    bytes_view data() const noexcept
+    {
+        return m_data != nullptr ? bytes_view{m_data, m_size} : bytes_view{m_buffer};
+    }
+};
+
+/// Loads the hex-encoded contents of the file. The whitespace is ignored.
+///
+/// @throws std::invalid_argument  In case the file cannot be opened or contains invalid hex.
+bytes load_hex_file(const std::string& path);
+
 int run(VM& vm,
         zvmc_revision rev,
         int64_t gas,
@@ -16,4 +59,83 @@ int run(VM& vm,
         bool create,
         bool bench,
         std::ostream& out);
+
+/// Benchmarks the execution of the contracts from the corpus directory.
+///
+/// Every subdirectory of the @p dir is a contract fixture containing the code.hex file
+/// and optionally the input.hex and the expected.hex (expected output) files.
+/// Each contract is benchmarked for approximately the @p time and the per-contract average
+/// execution times are summarized by their geometric mean.
+/// A fixture with a missing code.hex or with invalid hex in any of its files is reported
+/// as failed and the other contracts are still benchmarked.
+///
+/// @return  0 if all contracts executed successfully with the expected outputs, 1 otherwise.
+int bench_corpus(VM& vm,
+                 zvmc_revision rev,
+                 int64_t gas,
+                 const std::string& dir,
+                 std::chrono::milliseconds time,
+                 std::ostream& out);
+
+/// Calibrates the gas costs of the instructions against the VM execution time.
+///
+/// For every instruction of the revision, except the terminators, the loop repeating
+/// the instruction (with the stack setup: pushes of zero arguments and removals of the results)
+/// and the baseline loop with the same stack setup but without the instruction are benchmarked,
+/// each for approximately the @p time. The differences of the gas used and of the time per
+/// repetition, corrected by the measured cost of the removal of the stack items, and
+/// the nanoseconds per gas of the instruction are reported as JSON, in the opcode order
+/// and with the fixed precision, so the reports of different VMs or builds can be diffed.
+/// The stack items are removed with POP or, if the VM does not support it, with JUMPI.
+/// The instructions the VM fails to execute are reported with their status code only.
+///
+/// @return  0 on success, 1 if the revision has no instruction tables or the VM cannot
+///          execute the stack setup.
+int calibrate(VM& vm, zvmc_revision rev, std::chrono::milliseconds time, std::ostream& out);
+
+/// Compares the execution of the code by two VMs.
+///
+/// The VMs execute the code on identical fresh hosts and the results (status code, gas left
+/// and output) must match. Then the execution times are measured in interleaved samples
+/// (alternating the VM order) and the speedup of the VM B over the VM A is reported
+/// with the 95% confidence interval.
+///
+/// @return  0 if the results of both VMs match, 1 otherwise.
+int compare(VM& vm_a,
+            VM& vm_b,
+            zvmc_revision rev,
+            int64_t gas,
+            bytes_view code,
+            bytes_view input,
+            std::ostream& out);
+
+/// Disassembles the code.
+///
+/// Every instruction is printed in a separate line with its code offset and immediate data.
+/// The undefined instructions are printed as their opcodes in hex.
+///
+/// @return  0 on success, 1 if the revision has no instruction tables.
+int disasm(zvmc_revision rev, bytes_view code, std::ostream& out);
+
+/// Prints the histograms of the instructions, the instruction pairs and the instruction triples
+/// of the code corpus.
+///
+/// The corpus is every file in the @p dir tree with the .bin extension (the raw code, which is
+/// memory-mapped) or named code.hex (the hex code, the layout of bench_corpus()).
+/// The sequences do not span the files. Only the @p top most frequent entries of every
+/// histogram are printed.
+///
+/// @return  0 on success, 1 if the revision has no instruction tables.
+int stats(zvmc_revision rev, const std::string& dir, size_t top, std::ostream& out);
+
+/// Replays the recorded trace.
+///
+/// The messages are executed in order, each on a ReplayHost serving its recorded Host calls.
+/// The results of the executions (the status code, the gas left and refunded, the output
+/// and the create address) must match the recorded ones and the executions must request
+/// the same Host calls (including the storage writes) as during the recording.
+/// With @p bench the whole replay is also benchmarked.
+///
+/// @return  0 if the replay reproduced the trace, 1 otherwise.
+int replay(VM& vm, const Trace& trace, bool bench, std::ostream& out);
 }  // namespace zvmc::tooling
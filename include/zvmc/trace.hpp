@@ -0,0 +1,89 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+#pragma once
+
+#include <zvmc/hex.hpp>
+#include <zvmc/zvmc.hpp>
+#include <iosfwd>
+#include <vector>
+
+namespace zvmc
+{
+/// The result of an execution captured in a trace.
+struct TracedResult
+{
+    /// The status code.
+    zvmc_status_code status_code = ZVMC_INTERNAL_ERROR;
+
+    /// The amount of gas left.
+    int64_t gas_left = 0;
+
+    /// The amount of refunded gas.
+    int64_t gas_refund = 0;
+
+    /// The output data.
+    bytes output;
+
+    /// The address of the created account (for CREATE calls).
+    address create_address;
+};
+
+/// A top-level execution captured in a trace.
+struct TracedMessage
+{
+    /// The ZVM revision.
+    zvmc_revision rev = ZVMC_LATEST_STABLE_REVISION;
+
+    /// The message. The zvmc_message::input_data is ignored, the input is kept in the input field.
+    zvmc_message msg{};
+
+    /// The message input data.
+    bytes input;
+
+    /// The executed code.
+    bytes code;
+
+    /// The Host calls requested by the execution, as recorded by the RecordingHost.
+    bytes host_calls;
+
+    /// The execution result.
+    TracedResult result;
+};
+
+/// The trace of a sequence of executions (e.g. a block).
+///
+/// Every execution keeps the record of its Host calls, so replaying it with a ReplayHost
+/// reproduces all the Host responses observed during the recording: the state values,
+/// the account and storage access statuses, the transaction context and the nested call results.
+struct Trace
+{
+    /// The recorded executions in the execution order.
+    std::vector<TracedMessage> messages;
+};
+
+/// Writes the trace to the output stream in the binary format.
+void write_trace(std::ostream& out, const Trace& trace);
+
+/// Reads the trace in the binary format from the input stream.
+///
+/// @throws std::invalid_argument  In case the input is not a valid trace.
+Trace read_trace(std::istream& in);
+
+/// The recorder of the executions into a Trace.
+///
+/// The Host calls of every execution are forwarded to the wrapped Host and recorded
+/// with the RecordingHost.
+class TraceRecorder
+{
+    HostInterface& m_host;
+    Trace& m_trace;
+
+public:
+    /// Constructs the recorder of the executions using the @p host into the @p trace.
+    TraceRecorder(HostInterface& host, Trace& trace) noexcept : m_host{host}, m_trace{trace} {}
+
+    /// Executes the code with the VM and records the execution.
+    Result execute(VM& vm, zvmc_revision rev, const zvmc_message& msg, bytes_view code);
+};
+}  // namespace zvmc
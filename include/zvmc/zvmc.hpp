@@ -7,6 +7,7 @@
 #include <zvmc/hex.hpp>
 #include <zvmc/zvmc.h>
 
+#include <array>
 #include <functional>
 #include <initializer_list>
 #include <ostream>
@@ -279,6 +280,33 @@ inline constexpr bytes32::operator bool() const noexcept
     return !is_zero(*this);
 }
 
+namespace internal
+{
+/// Returns the number of bytes encoded by the characters of a raw hex literal.
+///
+/// The optional 0x prefix is not counted.
+template <char... Cs>
+constexpr size_t hex_literal_size() noexcept
+{
+    constexpr char s[] = {Cs...};
+    const size_t prefix_size = (sizeof(s) >= 2 && s[0] == '0' && s[1] == 'x') ? 2 : 0;
+    return (sizeof(s) - prefix_size) / 2;
+}
+
+/// Decodes the characters of a raw hex literal.
+///
+/// @return  The decoded bytes or std::nullopt if the characters are not valid hex.
+template <char... Cs>
+constexpr std::optional<std::array<uint8_t, hex_literal_size<Cs...>()>> parse_hex_literal() noexcept
+{
+    constexpr char s[] = {Cs...};
+    std::array<uint8_t, hex_literal_size<Cs...>()> r{};
+    if (!from_hex(std::begin(s), std::end(s), r.data()))
+        return {};
+    return r;
+}
+}  // namespace internal
+
 namespace literals
 {
 /// Converts a raw literal into value of type T.
@@ -314,6 +342,23 @@ constexpr bytes32 operator""_bytes32(const char* s) noexcept
 {
     return parse<bytes32>(s);
 }
+
+/// Literal for variable-length bytes, e.g. bytecode: 0x600160020f_hex.
+///
+/// The result is std::array<uint8_t, N> where N is the number of encoded bytes.
+/// The leading zeros are significant, so 0x0001_hex has two bytes.
+/// The literal is validated at compile time: an odd number of digits is an error.
+///
+/// This is a numeric raw literal, so the C++ number syntax applies: only the lowercase 0x
+/// prefix is accepted, the 0X prefix and the digit separators (0x60'01_hex) fail the validation,
+/// and literals without the prefix starting with 0 (0800_hex) are ill-formed octal numbers.
+template <char... Cs>
+constexpr auto operator""_hex() noexcept
+{
+    constexpr auto r = internal::parse_hex_literal<Cs...>();
+    static_assert(r.has_value(), "invalid hex literal");
+    return *r;
+}
 }  // namespace literals
 
 using namespace literals;
@@ -0,0 +1,363 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include <zvmc/analysis.h>
+#include <zvmc/instructions.h>
+
+#include <stdlib.h>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SSE2_SUPPORTED 1
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define AVX2_SUPPORTED 1
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ * The single allocation of the analysis: the header followed by the blocks and the bitmaps.
+ */
+struct analysis_storage
+{
+    struct zvmc_code_analysis analysis;
+    struct zvmc_code_block blocks[];
+};
+
+/**
+ * Checks if the instruction ends the basic block. The undefined instructions have no flags.
+ */
+static int ends_block(const struct zvmc_instruction_info* info)
+{
+    const unsigned mask = ZVMC_INSTRUCTION_DEFINED | ZVMC_INSTRUCTION_ENDS_BLOCK;
+    return (info->flags & mask) != ZVMC_INSTRUCTION_DEFINED;
+}
+
+/**
+ * The number of code bytes classified at once by the jumpdest scan.
+ */
+#define CHUNK_SIZE 64
+
+/**
+ * The masks of the chunk bytes being PUSH opcodes and JUMPDEST opcodes, regardless of
+ * whether the byte is an instruction or PUSH data.
+ */
+struct chunk_masks
+{
+    uint64_t push;
+    uint64_t jumpdest;
+};
+
+static unsigned count_trailing_zeros(uint64_t x)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, x);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctzll(x);
+#endif
+}
+
+/**
+ * Classifies the chunk bytes one at a time. Also handles the last, incomplete chunk.
+ */
+static struct chunk_masks classify_scalar(const uint8_t* chunk, size_t size)
+{
+    struct chunk_masks masks = {0, 0};
+    for (size_t i = 0; i < size; ++i)
+    {
+        // The PUSH1..PUSH32 opcodes are exactly the bytes 0b011xxxxx.
+        if ((chunk[i] & 0xe0) == OP_PUSH1)
+            masks.push |= (uint64_t)1 << i;
+        if (chunk[i] == OP_JUMPDEST)
+            masks.jumpdest |= (uint64_t)1 << i;
+    }
+    return masks;
+}
+
+#if SSE2_SUPPORTED
+static struct chunk_masks classify_sse2(const uint8_t* chunk)
+{
+    const __m128i push_bits = _mm_set1_epi8((char)0xe0);
+    const __m128i push_opcode = _mm_set1_epi8(OP_PUSH1);
+    const __m128i jumpdest_opcode = _mm_set1_epi8(OP_JUMPDEST);
+    struct chunk_masks masks = {0, 0};
+    for (int i = 0; i < CHUNK_SIZE / 16; ++i)
+    {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(const void*)(chunk + i * 16));
+        const __m128i push = _mm_cmpeq_epi8(_mm_and_si128(v, push_bits), push_opcode);
+        const __m128i jumpdest = _mm_cmpeq_epi8(v, jumpdest_opcode);
+        masks.push |= (uint64_t)(uint16_t)_mm_movemask_epi8(push) << (i * 16);
+        masks.jumpdest |= (uint64_t)(uint16_t)_mm_movemask_epi8(jumpdest) << (i * 16);
+    }
+    return masks;
+}
+#endif
+
+#if AVX2_SUPPORTED
+TARGET_AVX2 static struct chunk_masks classify_avx2(const uint8_t* chunk)
+{
+    const __m256i push_bits = _mm256_set1_epi8((char)0xe0);
+    const __m256i push_opcode = _mm256_set1_epi8(OP_PUSH1);
+    const __m256i jumpdest_opcode = _mm256_set1_epi8(OP_JUMPDEST);
+    struct chunk_masks masks = {0, 0};
+    for (int i = 0; i < CHUNK_SIZE / 32; ++i)
+    {
+        const __m256i v = _mm256_loadu_si256((const __m256i*)(const void*)(chunk + i * 32));
+        const __m256i push = _mm256_cmpeq_epi8(_mm256_and_si256(v, push_bits), push_opcode);
+        const __m256i jumpdest = _mm256_cmpeq_epi8(v, jumpdest_opcode);
+        masks.push |= (uint64_t)(uint32_t)_mm256_movemask_epi8(push) << (i * 32);
+        masks.jumpdest |= (uint64_t)(uint32_t)_mm256_movemask_epi8(jumpdest) << (i * 32);
+    }
+    return masks;
+}
+#endif
+
+/**
+ * Resolves which PUSH opcodes of the chunk are instructions and writes the chunk bitmaps.
+ *
+ * Only the PUSH instructions need to be visited one by one, as they are the only instructions
+ * with immediate data. The @p next_instruction is the code offset of the first instruction
+ * after the PUSH data seen so far and carries the PUSH data over the chunk boundaries.
+ */
+static void resolve_chunk(const uint8_t* code,
+                          size_t offset,
+                          size_t size,
+                          struct chunk_masks masks,
+                          size_t* next_instruction,
+                          uint8_t* jumpdest_map,
+                          uint8_t* push_data_map)
+{
+    const uint64_t chunk_mask = size == CHUNK_SIZE ? ~(uint64_t)0 : ((uint64_t)1 << size) - 1;
+
+    // The leading bytes being the PUSH data from the previous chunks.
+    uint64_t data = 0;
+    if (*next_instruction > offset)
+    {
+        const size_t carry = *next_instruction - offset;
+        data = carry >= CHUNK_SIZE ? ~(uint64_t)0 : ((uint64_t)1 << carry) - 1;
+    }
+
+    uint64_t pushes = masks.push & ~data;
+    while (pushes != 0)
+    {
+        const unsigned pos = count_trailing_zeros(pushes);
+        const unsigned end = pos + 1 + (unsigned)(code[offset + pos] - OP_PUSH1 + 1);
+        const uint64_t below_end = end >= CHUNK_SIZE ? ~(uint64_t)0 : ((uint64_t)1 << end) - 1;
+        data |= below_end & ~(((uint64_t)2 << pos) - 1);
+        pushes &= ~below_end;
+        *next_instruction = offset + end;
+    }
+
+    data &= chunk_mask;
+    const uint64_t jumpdests = masks.jumpdest & ~data;
+    for (size_t i = 0; i < (size + 7) / 8; ++i)
+    {
+        jumpdest_map[offset / 8 + i] = (uint8_t)(jumpdests >> (i * 8));
+        if (push_data_map != NULL)
+            push_data_map[offset / 8 + i] = (uint8_t)(data >> (i * 8));
+    }
+}
+
+void zvmc_analyze_jumpdests(const uint8_t* code,
+                            size_t code_size,
+                            uint8_t* jumpdest_map,
+                            uint8_t* push_data_map)
+{
+#if AVX2_SUPPORTED
+    const int use_avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+    size_t next_instruction = 0;
+    size_t offset = 0;
+    for (; code_size - offset >= CHUNK_SIZE; offset += CHUNK_SIZE)
+    {
+        struct chunk_masks masks;
+#if AVX2_SUPPORTED
+        if (use_avx2)
+            masks = classify_avx2(code + offset);
+        else
+#endif
+#if SSE2_SUPPORTED
+            masks = classify_sse2(code + offset);
+#else
+            masks = classify_scalar(code + offset, CHUNK_SIZE);
+#endif
+        resolve_chunk(code, offset, CHUNK_SIZE, masks, &next_instruction, jumpdest_map,
+                      push_data_map);
+    }
+
+    if (offset != code_size)
+    {
+        const size_t size = code_size - offset;
+        resolve_chunk(code, offset, size, classify_scalar(code + offset, size), &next_instruction,
+                      jumpdest_map, push_data_map);
+    }
+}
+
+/**
+ * Completes the block with the stack height change and the stack verdict.
+ */
+static void finish_block(struct zvmc_code_block* block, uint32_t end, int32_t stack_height)
+{
+    block->end = end;
+    block->stack_height_change = stack_height;
+    if (block->stack_height_entry < 0)
+        block->stack_verdict = ZVMC_STACK_CHECK_ENTRY;
+    else if (zvmc_check_block_stack(block, block->stack_height_entry))
+        block->stack_verdict = ZVMC_STACK_VALID;
+    else
+        block->stack_verdict = ZVMC_STACK_INVALID;
+}
+
+/**
+ * Scans the code and counts its basic blocks.
+ *
+ * If the output is given, the blocks are also filled in. It must be sized by the previous
+ * counting scan.
+ *
+ * The stack height at the block entry is propagated from the code beginning through
+ * the JUMPI fall-through of the valid blocks. The jump destinations may be entered
+ * from any jump, so their stack height is unknown.
+ */
+static size_t scan_code(const uint8_t* code,
+                        size_t code_size,
+                        const struct zvmc_instruction_info* info_table,
+                        struct zvmc_code_block* blocks)
+{
+    size_t num_blocks = 0;
+    int in_block = 0;
+    struct zvmc_code_block block = {0, 0, 0, 0, 0, 0, 0, ZVMC_STACK_CHECK_ENTRY};
+    int32_t stack_height = 0;
+    int32_t fall_through_stack_height = 0;  // The stack height at the next block entry.
+
+    size_t i = 0;
+    while (i < code_size)
+    {
+        const uint8_t op = code[i];
+
+        // The JUMPDEST starts a new block unless the current one is empty.
+        if (in_block && op == OP_JUMPDEST)
+        {
+            finish_block(&block, (uint32_t)i, stack_height);
+            if (blocks != NULL)
+                blocks[num_blocks] = block;
+            ++num_blocks;
+            in_block = 0;
+        }
+
+        if (!in_block)
+        {
+            block.begin = (uint32_t)i;
+            block.gas_cost = 0;
+            block.stack_height_required = 0;
+            block.stack_height_max_growth = 0;
+            block.stack_height_entry = op == OP_JUMPDEST ? -1 : fall_through_stack_height;
+            stack_height = 0;
+            in_block = 1;
+        }
+
+        const struct zvmc_instruction_info* info = &info_table[op];
+        block.gas_cost += info->gas_cost;
+        if (info->stack_height_required - stack_height > block.stack_height_required)
+            block.stack_height_required = info->stack_height_required - stack_height;
+        stack_height += info->stack_height_change;
+        if (stack_height > block.stack_height_max_growth)
+            block.stack_height_max_growth = stack_height;
+
+        // The PUSH data may be truncated by the end of the code.
+        i += 1;
+        i = code_size - i >= info->immediate_size ? i + info->immediate_size : code_size;
+
+        if (ends_block(info))
+        {
+            finish_block(&block, (uint32_t)i, stack_height);
+            fall_through_stack_height = op == OP_JUMPI && block.stack_verdict == ZVMC_STACK_VALID ?
+                                            block.stack_height_entry + stack_height :
+                                            -1;
+            if (blocks != NULL)
+                blocks[num_blocks] = block;
+            ++num_blocks;
+            in_block = 0;
+        }
+    }
+
+    if (in_block)
+    {
+        finish_block(&block, (uint32_t)code_size, stack_height);
+        if (blocks != NULL)
+            blocks[num_blocks] = block;
+        ++num_blocks;
+    }
+    return num_blocks;
+}
+
+struct zvmc_code_analysis* zvmc_analyze_code(enum zvmc_revision revision,
+                                             const uint8_t* code,
+                                             size_t code_size)
+{
+    const struct zvmc_instruction_info* info_table = zvmc_get_instruction_info_table(revision);
+    if (info_table == NULL)
+        return NULL;
+
+    // The block offsets are 32-bit.
+    if (code_size > UINT32_MAX)
+        return NULL;
+
+    const size_t num_blocks = scan_code(code, code_size, info_table, NULL);
+    const size_t map_size = (code_size + 7) / 8;
+    const size_t blocks_size = num_blocks * sizeof(struct zvmc_code_block);
+    struct analysis_storage* storage =
+        calloc(1, sizeof(struct analysis_storage) + blocks_size + 2 * map_size);
+    if (storage == NULL)
+        return NULL;
+
+    uint8_t* jumpdest_map = (uint8_t*)storage->blocks + blocks_size;
+    uint8_t* push_data_map = jumpdest_map + map_size;
+    scan_code(code, code_size, info_table, storage->blocks);
+    zvmc_analyze_jumpdests(code, code_size, jumpdest_map, push_data_map);
+
+    storage->analysis.code_size = code_size;
+    storage->analysis.jumpdest_map = jumpdest_map;
+    storage->analysis.push_data_map = push_data_map;
+    storage->analysis.num_blocks = num_blocks;
+    storage->analysis.blocks = storage->blocks;
+    return &storage->analysis;
+}
+
+void zvmc_free_code_analysis(struct zvmc_code_analysis* analysis)
+{
+    // The analysis is the first member of the storage.
+    free(analysis);
+}
+
+const struct zvmc_code_block* zvmc_find_code_block(const struct zvmc_code_analysis* analysis,
+                                                   size_t offset)
+{
+    if (offset >= analysis->code_size)
+        return NULL;
+
+    // Find the first block ending after the offset.
+    size_t first = 0;
+    size_t count = analysis->num_blocks;
+    while (count > 0)
+    {
+        const size_t step = count / 2;
+        if (analysis->blocks[first + step].end <= offset)
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+            count = step;
+    }
+    return &analysis->blocks[first];
+}
@@ -0,0 +1,40 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include <zvmc/instructions.h>
+
+/**
+ * The flags of the instruction list mapped to the zvmc_instruction_flags.
+ */
+enum
+{
+    TERMINATOR = ZVMC_INSTRUCTION_TERMINATOR | ZVMC_INSTRUCTION_ENDS_BLOCK,
+    JUMP = ZVMC_INSTRUCTION_JUMP | ZVMC_INSTRUCTION_ENDS_BLOCK,
+    DYNAMIC_GAS = ZVMC_INSTRUCTION_DYNAMIC_GAS,
+    MEMORY = ZVMC_INSTRUCTION_MEMORY,
+    HOST = ZVMC_INSTRUCTION_HOST,
+    READS_STATE = ZVMC_INSTRUCTION_READS_STATE,
+    WRITES_STATE = ZVMC_INSTRUCTION_WRITES_STATE
+};
+
+static const struct zvmc_instruction_info shanghai_info[256] = {
+#define ZVMC_INSTRUCTION(name, opcode, gas_cost, stack_height_required, stack_height_change, \
+                         immediate_size, flags)                                             \
+    [opcode] = {gas_cost, stack_height_required, stack_height_change, immediate_size,       \
+                ZVMC_INSTRUCTION_DEFINED | (flags)},
+#include <zvmc/instructions.def>
+#undef ZVMC_INSTRUCTION
+};
+
+const struct zvmc_instruction_info* zvmc_get_instruction_info_table(enum zvmc_revision revision)
+{
+    if (revision == ZVMC_SHANGHAI)
+    {
+        return shanghai_info;
+    }
+    else
+    {
+        return NULL;
+    }
+}
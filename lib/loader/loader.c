@@ -2,6 +2,10 @@
 // Copyright 2018 The EVMC Authors.
 // Licensed under the Apache License, Version 2.0.
 
+#if !defined(_WIN32) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE  // For realpath(), RTLD_DEEPBIND and dl_iterate_phdr() in strict C99 mode.
+#endif
+
 #include <zvmc/loader.h>
 
 #include <zvmc/helpers.h>
@@ -10,25 +14,137 @@
 #include <stdarg.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
+/// The flags controlling how the module is loaded, set by the loader options.
+enum
+{
+    LOAD_BIND_NOW = 1 << 0,  ///< Resolve all symbols when the module is loaded.
+    LOAD_DEEPBIND = 1 << 1,  ///< Prefer the module's own symbols over the global ones.
+    LOAD_PREFAULT = 1 << 2   ///< Make the module code resident before the first execution.
+};
+
 #if defined(ZVMC_LOADER_MOCK)
 #include "../../test/unittests/loader_mock.h"
+#define DLL_DEEPBIND_SUPPORTED 1
 #elif defined(_WIN32)
 #include <Windows.h>
 #define DLL_HANDLE HMODULE
-#define DLL_OPEN(filename) LoadLibrary(filename)
+#define DLL_OPEN(filename, flags) LoadLibrary(filename)
 #define DLL_CLOSE(handle) FreeLibrary(handle)
 #define DLL_GET_CREATE_FN(handle, name) (zvmc_create_fn)(uintptr_t) GetProcAddress(handle, name)
 #define DLL_GET_ERROR_MSG() NULL
+#define DLL_PREFAULT(handle, create_fn) (void)0
+#define DLL_DEEPBIND_SUPPORTED 0
 #else
 #include <dlfcn.h>
 #define DLL_HANDLE void*
-#define DLL_OPEN(filename) dlopen(filename, RTLD_LAZY)
+#define DLL_OPEN(filename, flags) dlopen(filename, get_dlopen_mode(flags))
 #define DLL_CLOSE(handle) dlclose(handle)
 // NOLINTNEXTLINE(performance-no-int-to-ptr)
 #define DLL_GET_CREATE_FN(handle, name) (zvmc_create_fn)(uintptr_t) dlsym(handle, name)
 #define DLL_GET_ERROR_MSG() dlerror()
+#define DLL_PREFAULT(handle, create_fn) prefault_module(create_fn)
+#if defined(RTLD_DEEPBIND)
+#define DLL_DEEPBIND_SUPPORTED 1
+#else
+#define DLL_DEEPBIND_SUPPORTED 0
+#endif
+
+static int get_dlopen_mode(int flags)
+{
+    int mode = (flags & LOAD_BIND_NOW) ? RTLD_NOW : RTLD_LAZY;
+#if defined(RTLD_DEEPBIND)
+    if (flags & LOAD_DEEPBIND)
+        mode |= RTLD_DEEPBIND;
+#endif
+    return mode;
+}
+
+#if defined(__linux__)
+#include <link.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/// Prefaults the executable segments of the loaded object if it contains the address in data.
+/// This is the dl_iterate_phdr() callback.
+static int prefault_object(struct dl_phdr_info* info, size_t size, void* data)
+{
+    (void)size;
+    const uintptr_t address = (uintptr_t)data;
+
+    int found = 0;
+    for (size_t i = 0; i < info->dlpi_phnum; ++i)
+    {
+        const ElfW(Phdr)* phdr = &info->dlpi_phdr[i];
+        const uintptr_t begin = info->dlpi_addr + phdr->p_vaddr;
+        if (phdr->p_type == PT_LOAD && address >= begin && address - begin < phdr->p_memsz)
+            found = 1;
+    }
+    if (!found)
+        return 0;  // Continue with the next object.
+
+    const uintptr_t page_size = (uintptr_t)sysconf(_SC_PAGESIZE);
+    for (size_t i = 0; i < info->dlpi_phnum; ++i)
+    {
+        const ElfW(Phdr)* phdr = &info->dlpi_phdr[i];
+        if (phdr->p_type != PT_LOAD || (phdr->p_flags & PF_X) == 0)
+            continue;
+
+        const uintptr_t begin = (info->dlpi_addr + phdr->p_vaddr) & ~(page_size - 1);
+        const uintptr_t end = info->dlpi_addr + phdr->p_vaddr + phdr->p_memsz;
+        // NOLINTNEXTLINE(performance-no-int-to-ptr)
+        void* const pages = (void*)begin;
+#if defined(MADV_HUGEPAGE)
+        // Allow the kernel to back the code with huge pages if it supports it for file mappings.
+        madvise(pages, end - begin, MADV_HUGEPAGE);
+#endif
+        madvise(pages, end - begin, MADV_WILLNEED);
+
+        // Touch every page, so page faults do not happen during the first executions.
+        for (uintptr_t p = begin; p < end; p += page_size)
+            (void)*(volatile const uint8_t*)p;  // NOLINT(performance-no-int-to-ptr)
+    }
+    return 1;  // Stop the iteration.
+}
+
+static void prefault_module(zvmc_create_fn create_fn)
+{
+    dl_iterate_phdr(prefault_object, (void*)(uintptr_t)create_fn);
+}
+#else
+static void prefault_module(zvmc_create_fn create_fn)
+{
+    (void)create_fn;  // Not supported, the option is only a hint.
+}
+#endif
+#endif
+
+#if defined(_WIN32)
+#include <Windows.h>
+#define THREAD_HANDLE HANDLE
+#define THREAD_RETURN DWORD WINAPI
+#define THREAD_START(thread, fn, arg) \
+    ((*(thread) = CreateThread(NULL, 0, fn, arg, 0, NULL)) != NULL)
+#define THREAD_JOIN(thread) (WaitForSingleObject(thread, INFINITE), CloseHandle(thread))
+#define ATOMIC_INDEX volatile LONG
+#define ATOMIC_FETCH_INC(index) (InterlockedIncrement(index) - 1)
+static SRWLOCK registry_lock = SRWLOCK_INIT;
+#define REGISTRY_LOCK() AcquireSRWLockExclusive(&registry_lock)
+#define REGISTRY_UNLOCK() ReleaseSRWLockExclusive(&registry_lock)
+#else
+#include <pthread.h>
+#include <unistd.h>
+#define THREAD_HANDLE pthread_t
+#define THREAD_RETURN void*
+#define THREAD_START(thread, fn, arg) (pthread_create(thread, NULL, fn, arg) == 0)
+#define THREAD_JOIN(thread) pthread_join(thread, NULL)
+#define ATOMIC_INDEX long
+#define ATOMIC_FETCH_INC(index) __atomic_fetch_add(index, 1, __ATOMIC_RELAXED)
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+#define REGISTRY_LOCK() pthread_mutex_lock(&registry_lock)
+#define REGISTRY_UNLOCK() pthread_mutex_unlock(&registry_lock)
 #endif
 
 #ifdef __has_attribute
@@ -42,6 +158,12 @@
 #define ATTR_FORMAT(...)
 #endif
 
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
 /*
  * Limited variant of strcpy_s().
  */
@@ -69,14 +191,15 @@ static
 enum
 {
     PATH_MAX_LENGTH = 4096,
+    MAX_STATIC_VMS = 32,
     LAST_ERROR_MSG_BUFFER_SIZE = 511
 };
 
-static const char* last_error_msg = NULL;
+// The error state is kept per thread, so loading VMs concurrently does not mix error messages.
+static THREAD_LOCAL const char* last_error_msg = NULL;
 
 // Buffer for formatted error messages.
-// It has one null byte extra to avoid buffer read overflow during concurrent access.
-static char last_error_msg_buffer[LAST_ERROR_MSG_BUFFER_SIZE + 1];
+static THREAD_LOCAL char last_error_msg_buffer[LAST_ERROR_MSG_BUFFER_SIZE + 1];
 
 ATTR_FORMAT(printf, 2, 3)
 static enum zvmc_loader_error_code set_error(enum zvmc_loader_error_code error_code,
@@ -94,44 +217,64 @@ static enum zvmc_loader_error_code set_error(enum zvmc_loader_error_code error_c
 }
 
 
-zvmc_create_fn zvmc_load(const char* filename, enum zvmc_loader_error_code* error_code)
+/// The loaded ZVMC module kept in the registry.
+struct loaded_module
 {
-    last_error_msg = NULL;  // Reset last error.
-    enum zvmc_loader_error_code ec = ZVMC_LOADER_SUCCESS;
-    zvmc_create_fn create_fn = NULL;
+    struct loaded_module* next;  ///< The next module in the registry list.
+    DLL_HANDLE handle;           ///< The handle of the loaded DLL.
+    zvmc_create_fn create_fn;    ///< The resolved VM create function.
+    int ref_count;               ///< The number of not released zvmc_load() results.
+    char* path;                  ///< The registry key (see get_module_key()), allocated in place.
+};
 
-    if (!filename)
-    {
-        ec = set_error(ZVMC_LOADER_INVALID_ARGUMENT, "invalid argument: file name cannot be null");
-        goto exit;
-    }
+/// The registry of loaded modules. Guarded by the registry_lock.
+static struct loaded_module* registry = NULL;
 
-    const size_t length = strlen(filename);
-    if (length == 0)
-    {
-        ec = set_error(ZVMC_LOADER_INVALID_ARGUMENT, "invalid argument: file name cannot be empty");
-        goto exit;
-    }
-    else if (length > PATH_MAX_LENGTH)
-    {
-        ec = set_error(ZVMC_LOADER_INVALID_ARGUMENT,
-                       "invalid argument: file name is too long (%d, maximum allowed length is %d)",
-                       (int)length, PATH_MAX_LENGTH);
-        goto exit;
-    }
+/// Returns the pointer to the file name in the path, i.e. the position after the last separator.
+static const char* find_file_name(const char* path)
+{
+    const char* sep_pos = strrchr(path, '/');
+#ifdef _WIN32
+    // On Windows check also Windows classic path separator.
+    const char* sep_pos_windows = strrchr(path, '\\');
+    sep_pos = sep_pos_windows > sep_pos ? sep_pos_windows : sep_pos;
+#endif
+    return sep_pos ? sep_pos + 1 : path;
+}
 
-    DLL_HANDLE handle = DLL_OPEN(filename);
-    if (!handle)
-    {
-        // Get error message if available.
-        last_error_msg = DLL_GET_ERROR_MSG();
-        if (last_error_msg)
-            ec = ZVMC_LOADER_CANNOT_OPEN;
-        else
-            ec = set_error(ZVMC_LOADER_CANNOT_OPEN, "cannot open %s", filename);
-        goto exit;
-    }
+/// Gets the key identifying the module in the registry.
+///
+/// Paths with a directory component are resolved to the canonical absolute path, so different
+/// spellings of the same file share the registry entry. Bare file names are searched by the OS
+/// in the library search path, so they are used as given. The same applies to paths which cannot
+/// be resolved, the DLL_OPEN() is going to report the error for them.
+static const char* get_module_key(const char* filename, char key[PATH_MAX_LENGTH])
+{
+    if (find_file_name(filename) == filename)
+        return filename;
 
+#if defined(_WIN32)
+    const DWORD length = GetFullPathNameA(filename, PATH_MAX_LENGTH, key, NULL);
+    return (length != 0 && length < PATH_MAX_LENGTH) ? key : filename;
+#else
+    // The PATH_MAX_LENGTH matches the PATH_MAX on Linux which is the buffer size realpath() needs.
+    return realpath(filename, key) ? key : filename;
+#endif
+}
+
+/// Finds the registry entry pointer of the module with the given key.
+/// Returns the pointer to the null pointer at the end of the list if the module is not loaded.
+static struct loaded_module** find_module(const char* key)
+{
+    struct loaded_module** it = &registry;
+    while (*it && strcmp((*it)->path, key) != 0)
+        it = &(*it)->next;
+    return it;
+}
+
+/// Finds the VM create function in the loaded DLL, see zvmc_load() for the naming rules.
+static zvmc_create_fn find_create_fn(DLL_HANDLE handle, const char* filename)
+{
     // Create name buffer with the prefix.
     const char prefix[] = "zvmc_create_";
     const size_t prefix_length = strlen(prefix);
@@ -139,13 +282,7 @@ zvmc_create_fn zvmc_load(const char* filename, enum zvmc_loader_error_code* erro
     strcpy_sx(prefixed_name, sizeof(prefixed_name), prefix);
 
     // Find filename in the path.
-    const char* sep_pos = strrchr(filename, '/');
-#ifdef _WIN32
-    // On Windows check also Windows classic path separator.
-    const char* sep_pos_windows = strrchr(filename, '\\');
-    sep_pos = sep_pos_windows > sep_pos ? sep_pos_windows : sep_pos;
-#endif
-    const char* name_pos = sep_pos ? sep_pos + 1 : filename;
+    const char* name_pos = find_file_name(filename);
 
     // Skip "lib" prefix if present.
     const char lib_prefix[] = "lib";
@@ -167,24 +304,295 @@ zvmc_create_fn zvmc_load(const char* filename, enum zvmc_loader_error_code* erro
         *dash_pos++ = '_';
 
     // Search for the built function name.
-    create_fn = DLL_GET_CREATE_FN(handle, prefixed_name);
+    zvmc_create_fn create_fn = DLL_GET_CREATE_FN(handle, prefixed_name);
 
     if (!create_fn)
         create_fn = DLL_GET_CREATE_FN(handle, "zvmc_create");
 
+    return create_fn;
+}
+
+/// Loads the module or takes the already loaded one from the registry.
+///
+/// The registry_lock is not held while the module is opened and prefaulted: the module
+/// constructors may call the loader (e.g. zvmc_register_static_vm()) and the loads of different
+/// modules should not wait for each other. If the same module is loaded concurrently,
+/// the first registered handle wins and the other one is closed.
+static zvmc_create_fn load_module(const char* filename,
+                                  const char* key,
+                                  int flags,
+                                  enum zvmc_loader_error_code* error_code)
+{
+    zvmc_create_fn loaded_create_fn = NULL;
+    REGISTRY_LOCK();
+    struct loaded_module* m = *find_module(key);
+    if (m)
+    {
+        ++m->ref_count;
+        loaded_create_fn = m->create_fn;
+    }
+    REGISTRY_UNLOCK();
+    if (loaded_create_fn)
+        return loaded_create_fn;
+
+    DLL_HANDLE handle = DLL_OPEN(filename, flags);
+    if (!handle)
+    {
+        // Get error message if available.
+        last_error_msg = DLL_GET_ERROR_MSG();
+        if (last_error_msg)
+            *error_code = ZVMC_LOADER_CANNOT_OPEN;
+        else
+            *error_code = set_error(ZVMC_LOADER_CANNOT_OPEN, "cannot open %s", filename);
+        return NULL;
+    }
+
+    const zvmc_create_fn create_fn = find_create_fn(handle, filename);
     if (!create_fn)
     {
         DLL_CLOSE(handle);
-        ec = set_error(ZVMC_LOADER_SYMBOL_NOT_FOUND, "ZVMC create function not found in %s",
-                       filename);
+        *error_code = set_error(ZVMC_LOADER_SYMBOL_NOT_FOUND,
+                                "ZVMC create function not found in %s", filename);
+        return NULL;
     }
 
+    if (flags & LOAD_PREFAULT)
+        DLL_PREFAULT(handle, create_fn);
+
+    // The entry is allocated before taking the lock. If it cannot be allocated the module
+    // is still usable, but not cached.
+    const size_t key_size = strlen(key) + 1;
+    struct loaded_module* new_m = malloc(sizeof(*new_m) + key_size);
+
+    REGISTRY_LOCK();
+    m = *find_module(key);
+    if (m)
+    {
+        ++m->ref_count;  // Loaded by another thread in the meantime.
+        loaded_create_fn = m->create_fn;
+    }
+    else if (new_m)
+    {
+        new_m->handle = handle;
+        new_m->create_fn = create_fn;
+        new_m->ref_count = 1;
+        new_m->path = (char*)(new_m + 1);
+        memcpy(new_m->path, key, key_size);
+        new_m->next = registry;
+        registry = new_m;
+    }
+    REGISTRY_UNLOCK();
+
+    if (!loaded_create_fn)
+        return create_fn;
+
+    // Drop the duplicate handle, the OS keeps the module loaded for the registered one.
+    free(new_m);
+    DLL_CLOSE(handle);
+    return loaded_create_fn;
+}
+
+/// The VM registered with zvmc_register_static_vm().
+struct static_vm
+{
+    char* name;  ///< The copy of the name, so the lookups do not depend on the caller's memory.
+    zvmc_create_fn create_fn;
+};
+
+/// The table of statically linked VMs. Guarded by the registry_lock.
+static struct static_vm static_vms[MAX_STATIC_VMS];
+
+/// The number of the registered statically linked VMs. Guarded by the registry_lock.
+static size_t num_static_vms = 0;
+
+/// The prefix of the paths referring to the statically linked VMs.
+static const char static_vm_prefix[] = "static:";
+
+/// Finds the statically linked VM. Must be called with the registry_lock held.
+static struct static_vm* find_static_vm(const char* name)
+{
+    for (size_t i = 0; i < num_static_vms; ++i)
+    {
+        if (strcmp(static_vms[i].name, name) == 0)
+            return &static_vms[i];
+    }
+    return NULL;
+}
+
+int zvmc_register_static_vm(const char* name, zvmc_create_fn create_fn)
+{
+    if (!name || strlen(name) == 0 || !create_fn)
+        return 0;
+
+    // The name is copied before taking the lock.
+    const size_t name_size = strlen(name) + 1;
+    char* name_copy = malloc(name_size);
+    if (!name_copy)
+        return 0;
+    memcpy(name_copy, name, name_size);
+
+    int registered = 0;
+    REGISTRY_LOCK();
+    if (num_static_vms < MAX_STATIC_VMS && !find_static_vm(name))
+    {
+        static_vms[num_static_vms].name = name_copy;
+        static_vms[num_static_vms].create_fn = create_fn;
+        ++num_static_vms;
+        registered = 1;
+    }
+    REGISTRY_UNLOCK();
+
+    if (!registered)
+        free(name_copy);
+    return registered;
+}
+
+int zvmc_unregister_static_vm(const char* name)
+{
+    if (!name)
+        return 0;
+
+    char* removed_name = NULL;
+    REGISTRY_LOCK();
+    struct static_vm* vm = find_static_vm(name);
+    if (vm)
+    {
+        removed_name = vm->name;
+        // Keep the registration order of the remaining VMs.
+        const size_t index = (size_t)(vm - static_vms);
+        memmove(vm, vm + 1, (num_static_vms - index - 1) * sizeof(*vm));
+        --num_static_vms;
+    }
+    REGISTRY_UNLOCK();
+
+    free(removed_name);
+    return removed_name != NULL;
+}
+
+zvmc_create_fn zvmc_find_static_vm(const char* name)
+{
+    if (!name)
+        return NULL;
+
+    REGISTRY_LOCK();
+    const struct static_vm* vm = find_static_vm(name);
+    const zvmc_create_fn create_fn = vm ? vm->create_fn : NULL;
+    REGISTRY_UNLOCK();
+    return create_fn;
+}
+
+/// Loads the module as zvmc_load() with the given loader option flags.
+static zvmc_create_fn load(const char* filename,
+                           int flags,
+                           enum zvmc_loader_error_code* error_code)
+{
+    last_error_msg = NULL;  // Reset last error.
+    enum zvmc_loader_error_code ec = ZVMC_LOADER_SUCCESS;
+    zvmc_create_fn create_fn = NULL;
+
+    if (!filename)
+    {
+        ec = set_error(ZVMC_LOADER_INVALID_ARGUMENT, "invalid argument: file name cannot be null");
+        goto exit;
+    }
+
+    const size_t length = strlen(filename);
+    if (length == 0)
+    {
+        ec = set_error(ZVMC_LOADER_INVALID_ARGUMENT, "invalid argument: file name cannot be empty");
+        goto exit;
+    }
+    else if (length > PATH_MAX_LENGTH)
+    {
+        ec = set_error(ZVMC_LOADER_INVALID_ARGUMENT,
+                       "invalid argument: file name is too long (%d, maximum allowed length is %d)",
+                       (int)length, PATH_MAX_LENGTH);
+        goto exit;
+    }
+
+    // The statically linked VMs are not loaded, so the loader flags do not apply to them.
+    const size_t static_vm_prefix_length = sizeof(static_vm_prefix) - 1;
+    if (strncmp(filename, static_vm_prefix, static_vm_prefix_length) == 0)
+    {
+        const char* name = filename + static_vm_prefix_length;
+        create_fn = zvmc_find_static_vm(name);
+        if (!create_fn)
+            ec = set_error(ZVMC_LOADER_CANNOT_OPEN, "static VM '%s' is not registered", name);
+        goto exit;
+    }
+
+    char key_buffer[PATH_MAX_LENGTH];
+    const char* key = get_module_key(filename, key_buffer);
+
+    create_fn = load_module(filename, key, flags, &ec);
+
 exit:
     if (error_code)
         *error_code = ec;
     return create_fn;
 }
 
+zvmc_create_fn zvmc_load(const char* filename, enum zvmc_loader_error_code* error_code)
+{
+    return load(filename, 0, error_code);
+}
+
+int zvmc_release(const char* filename, int unload)
+{
+    if (!filename || strlen(filename) > PATH_MAX_LENGTH)
+        return -1;
+
+    char key_buffer[PATH_MAX_LENGTH];
+    const char* key = get_module_key(filename, key_buffer);
+
+    // The entry is unlinked under the registry_lock, but the module is closed after releasing
+    // it: the module destructors may call the loader (e.g. zvmc_unregister_static_vm()).
+    int ref_count = -1;
+    struct loaded_module* unloaded = NULL;
+    REGISTRY_LOCK();
+    struct loaded_module** it = find_module(key);
+    struct loaded_module* m = *it;
+    if (m)
+    {
+        if (m->ref_count > 0)
+            --m->ref_count;
+        ref_count = m->ref_count;
+
+        if (ref_count == 0 && unload)
+        {
+            *it = m->next;
+            unloaded = m;
+        }
+    }
+    REGISTRY_UNLOCK();
+
+    if (unloaded)
+    {
+        DLL_CLOSE(unloaded->handle);
+        free(unloaded);
+    }
+    return ref_count;
+}
+
+#if defined(ZVMC_LOADER_MOCK)
+/// Unloads all modules from the registry. Exposed to unittests when building with ZVMC_LOADER_MOCK.
+void zvmc_test_reset_registry(void)
+{
+    REGISTRY_LOCK();
+    struct loaded_module* m = registry;
+    registry = NULL;
+    REGISTRY_UNLOCK();
+
+    while (m)
+    {
+        struct loaded_module* next = m->next;
+        DLL_CLOSE(m->handle);
+        free(m);
+        m = next;
+    }
+}
+#endif
+
 const char* zvmc_last_error_msg(void)
 {
     const char* m = last_error_msg;
@@ -192,10 +600,13 @@ const char* zvmc_last_error_msg(void)
     return m;
 }
 
-struct zvmc_vm* zvmc_load_and_create(const char* filename, enum zvmc_loader_error_code* error_code)
+/// Loads the module and creates the VM as zvmc_load_and_create() with the given loader flags.
+static struct zvmc_vm* load_and_create(const char* filename,
+                                       int flags,
+                                       enum zvmc_loader_error_code* error_code)
 {
     // First load the DLL. This also resets the last_error_msg;
-    zvmc_create_fn create_fn = zvmc_load(filename, error_code);
+    zvmc_create_fn create_fn = load(filename, flags, error_code);
 
     if (!create_fn)
         return NULL;
@@ -207,6 +618,7 @@ struct zvmc_vm* zvmc_load_and_create(const char* filename, enum zvmc_loader_erro
     {
         ec = set_error(ZVMC_LOADER_VM_CREATION_FAILURE, "creating ZVMC VM of %s has failed",
                        filename);
+        zvmc_release(filename, 0);
         goto exit;
     }
 
@@ -217,6 +629,7 @@ struct zvmc_vm* zvmc_load_and_create(const char* filename, enum zvmc_loader_erro
                        vm->abi_version, filename, ZVMC_ABI_VERSION);
         zvmc_destroy(vm);
         vm = NULL;
+        zvmc_release(filename, 0);
         goto exit;
     }
 
@@ -227,6 +640,11 @@ exit:
     return vm;
 }
 
+struct zvmc_vm* zvmc_load_and_create(const char* filename, enum zvmc_loader_error_code* error_code)
+{
+    return load_and_create(filename, 0, error_code);
+}
+
 /// Gets the token delimited by @p delim character of the string pointed by the @p str_ptr.
 /// If the delimiter is not found, the whole string is returned.
 /// The @p str_ptr is also slided after the delimiter or to the string end
@@ -250,6 +668,92 @@ static char* get_token(char** str_ptr, char delim)
     return str;
 }
 
+/// Parses the loader options of the path, i.e. the "?" separated options following the file name.
+/// The @p path is null-terminated after the file name.
+static enum zvmc_loader_error_code parse_loader_options(char* path, int* flags)
+{
+    char* options = path;
+    const char* filename = get_token(&options, '?');
+
+    *flags = 0;
+    while (strlen(options) != 0)
+    {
+        char* value = get_token(&options, '?');
+        const char* name = get_token(&value, '=');
+
+        int valid_value = 0;
+        if (strcmp(name, "bind") == 0)
+        {
+            valid_value = strcmp(value, "now") == 0 || strcmp(value, "lazy") == 0;
+            if (strcmp(value, "now") == 0)
+                *flags |= LOAD_BIND_NOW;
+            else
+                *flags &= ~LOAD_BIND_NOW;
+        }
+        else if (strcmp(name, "deepbind") == 0)
+        {
+            if (!DLL_DEEPBIND_SUPPORTED)
+            {
+                return set_error(ZVMC_LOADER_INVALID_OPTION_NAME,
+                                 "%s: loader option '%s' is not supported on this platform",
+                                 filename, name);
+            }
+            valid_value = strlen(value) == 0;
+            *flags |= LOAD_DEEPBIND;
+        }
+        else if (strcmp(name, "prefault") == 0)
+        {
+            valid_value = strlen(value) == 0;
+            *flags |= LOAD_PREFAULT;
+        }
+        else
+        {
+            return set_error(ZVMC_LOADER_INVALID_OPTION_NAME, "%s: unknown loader option '%s'",
+                             filename, name);
+        }
+
+        if (!valid_value)
+        {
+            return set_error(ZVMC_LOADER_INVALID_OPTION_VALUE,
+                             "%s: unsupported value '%s' for loader option '%s'", filename, value,
+                             name);
+        }
+    }
+    return ZVMC_LOADER_SUCCESS;
+}
+
+/// Sets the VM option and reports the error, if any.
+static enum zvmc_loader_error_code set_vm_option(struct zvmc_vm* vm,
+                                                 const char* path,
+                                                 const char* name,
+                                                 const char* value)
+{
+    if (vm->set_option == NULL)
+    {
+        return set_error(ZVMC_LOADER_INVALID_OPTION_NAME, "%s (%s) does not support any options",
+                         vm->name, path);
+    }
+
+    enum zvmc_set_option_result r = vm->set_option(vm, name, value);
+    switch (r)
+    {
+    case ZVMC_SET_OPTION_SUCCESS:
+        return ZVMC_LOADER_SUCCESS;
+    case ZVMC_SET_OPTION_INVALID_NAME:
+        return set_error(ZVMC_LOADER_INVALID_OPTION_NAME, "%s (%s): unknown option '%s'", vm->name,
+                         path, name);
+    case ZVMC_SET_OPTION_INVALID_VALUE:
+        return set_error(ZVMC_LOADER_INVALID_OPTION_VALUE,
+                         "%s (%s): unsupported value '%s' for option '%s'", vm->name, path, value,
+                         name);
+
+    default:
+        return set_error(ZVMC_LOADER_INVALID_OPTION_VALUE,
+                         "%s (%s): unknown error when setting value '%s' for option '%s'",
+                         vm->name, path, value, name);
+    }
+}
+
 struct zvmc_vm* zvmc_load_and_configure(const char* config, enum zvmc_loader_error_code* error_code)
 {
     enum zvmc_loader_error_code ec = ZVMC_LOADER_SUCCESS;
@@ -265,48 +769,27 @@ struct zvmc_vm* zvmc_load_and_configure(const char* config, enum zvmc_loader_err
     }
 
     char* options = config_copy_buffer;
-    const char* path = get_token(&options, ',');
+    char* path = get_token(&options, ',');
 
-    vm = zvmc_load_and_create(path, error_code);
+    int flags = 0;
+    last_error_msg = NULL;  // Reset last error.
+    ec = parse_loader_options(path, &flags);
+    if (ec != ZVMC_LOADER_SUCCESS)
+        goto exit;
+
+    vm = load_and_create(path, flags, error_code);
     if (!vm)
         return NULL;
 
-    while (strlen(options) != 0)
+    while (strlen(options) != 0 && ec == ZVMC_LOADER_SUCCESS)
     {
-        if (vm->set_option == NULL)
-        {
-            ec = set_error(ZVMC_LOADER_INVALID_OPTION_NAME, "%s (%s) does not support any options",
-                           vm->name, path);
-            goto exit;
-        }
-
         char* option = get_token(&options, ',');
 
         // Slit option into name and value by taking the name token.
         // The option variable will have the value, can be empty.
         const char* name = get_token(&option, '=');
 
-        enum zvmc_set_option_result r = vm->set_option(vm, name, option);
-        switch (r)
-        {
-        case ZVMC_SET_OPTION_SUCCESS:
-            break;
-        case ZVMC_SET_OPTION_INVALID_NAME:
-            ec = set_error(ZVMC_LOADER_INVALID_OPTION_NAME, "%s (%s): unknown option '%s'",
-                           vm->name, path, name);
-            goto exit;
-        case ZVMC_SET_OPTION_INVALID_VALUE:
-            ec = set_error(ZVMC_LOADER_INVALID_OPTION_VALUE,
-                           "%s (%s): unsupported value '%s' for option '%s'", vm->name, path,
-                           option, name);
-            goto exit;
-
-        default:
-            ec = set_error(ZVMC_LOADER_INVALID_OPTION_VALUE,
-                           "%s (%s): unknown error when setting value '%s' for option '%s'",
-                           vm->name, path, option, name);
-            goto exit;
-        }
+        ec = set_vm_option(vm, path, name, option);
     }
 
 exit:
@@ -317,6 +800,394 @@ exit:
         return vm;
 
     if (vm)
+    {
         zvmc_destroy(vm);
+        zvmc_release(path, 0);
+    }
+    return NULL;
+}
+
+struct zvmc_vm* zvmc_load_and_configure_r(const char* config,
+                                          enum zvmc_loader_error_code* error_code,
+                                          char* error_msg,
+                                          size_t error_msg_size)
+{
+    struct zvmc_vm* vm = zvmc_load_and_configure(config, error_code);
+
+    // Move the error message of this thread to the provided buffer, truncating it if needed.
+    const char* msg = zvmc_last_error_msg();
+    if (error_msg && error_msg_size != 0)
+    {
+        const size_t length = msg ? strlen(msg) : 0;
+        const size_t copy_length = length < error_msg_size ? length : error_msg_size - 1;
+        if (copy_length != 0)
+            memcpy(error_msg, msg, copy_length);
+        error_msg[copy_length] = 0;
+    }
+    return vm;
+}
+
+/// The VM option of the option set.
+struct vm_option
+{
+    const char* name;
+    const char* value;
+};
+
+struct zvmc_option_set
+{
+    char* path;                ///< The path of the ZVMC module, without the loader options.
+    int flags;                 ///< The loader option flags.
+    size_t num_options;        ///< The number of the VM options.
+    struct vm_option* options; ///< The VM options, allocated in place.
+};
+
+struct zvmc_option_set* zvmc_parse_options(const char* config,
+                                           enum zvmc_loader_error_code* error_code)
+{
+    last_error_msg = NULL;  // Reset last error.
+    enum zvmc_loader_error_code ec = ZVMC_LOADER_SUCCESS;
+    struct zvmc_option_set* set = NULL;
+
+    if (!config)
+    {
+        ec = set_error(ZVMC_LOADER_INVALID_ARGUMENT,
+                       "invalid argument: configuration cannot be null");
+        goto exit;
+    }
+
+    // Every option is preceded by a comma, so the number of commas bounds the number of options.
+    // The option set, the options and the copy of the config string share a single allocation.
+    size_t max_num_options = 0;
+    for (const char* c = config; *c != 0; ++c)
+        max_num_options += *c == ',';
+    const size_t config_size = strlen(config) + 1;
+    set = malloc(sizeof(*set) + max_num_options * sizeof(struct vm_option) + config_size);
+    if (!set)
+    {
+        ec = set_error(ZVMC_LOADER_UNSPECIFIED_ERROR, "out of memory");
+        goto exit;
+    }
+    set->options = (struct vm_option*)(set + 1);
+    char* options = (char*)(set->options + max_num_options);
+    memcpy(options, config, config_size);
+
+    set->path = get_token(&options, ',');
+    ec = parse_loader_options(set->path, &set->flags);
+    if (ec != ZVMC_LOADER_SUCCESS)
+    {
+        free(set);
+        set = NULL;
+        goto exit;
+    }
+
+    set->num_options = 0;
+    while (strlen(options) != 0)
+    {
+        char* option = get_token(&options, ',');
+        struct vm_option* o = &set->options[set->num_options++];
+        o->name = get_token(&option, '=');
+        o->value = option;
+    }
+
+exit:
+    if (error_code)
+        *error_code = ec;
+    return set;
+}
+
+void zvmc_free_options(struct zvmc_option_set* options)
+{
+    free(options);
+}
+
+const char* zvmc_option_set_path(const struct zvmc_option_set* options)
+{
+    return options->path;
+}
+
+enum zvmc_loader_error_code zvmc_apply_options(const struct zvmc_option_set* options,
+                                               struct zvmc_vm* vm)
+{
+    last_error_msg = NULL;  // Reset last error.
+    for (size_t i = 0; i < options->num_options; ++i)
+    {
+        const struct vm_option* o = &options->options[i];
+        const enum zvmc_loader_error_code ec = set_vm_option(vm, options->path, o->name, o->value);
+        if (ec != ZVMC_LOADER_SUCCESS)
+            return ec;
+    }
+    return ZVMC_LOADER_SUCCESS;
+}
+
+struct zvmc_vm* zvmc_create_with_options(const struct zvmc_option_set* options,
+                                         enum zvmc_loader_error_code* error_code)
+{
+    struct zvmc_vm* vm = load_and_create(options->path, options->flags, error_code);
+    if (!vm)
+        return NULL;
+
+    const enum zvmc_loader_error_code ec = zvmc_apply_options(options, vm);
+    if (error_code)
+        *error_code = ec;
+    if (ec == ZVMC_LOADER_SUCCESS)
+        return vm;
+
+    zvmc_destroy(vm);
+    zvmc_release(options->path, 0);
     return NULL;
 }
+
+// The Host for warmup executions: the state is empty and all the calls fail.
+// It is stateless, so it is safe to be used from multiple threads.
+
+static bool warmup_account_exists(struct zvmc_host_context* context, const zvmc_address* address)
+{
+    (void)context;
+    (void)address;
+    return false;
+}
+
+static zvmc_bytes32 warmup_get_storage(struct zvmc_host_context* context,
+                                       const zvmc_address* address,
+                                       const zvmc_bytes32* key)
+{
+    (void)context;
+    (void)address;
+    (void)key;
+    zvmc_bytes32 value = {{0}};
+    return value;
+}
+
+static enum zvmc_storage_status warmup_set_storage(struct zvmc_host_context* context,
+                                                   const zvmc_address* address,
+                                                   const zvmc_bytes32* key,
+                                                   const zvmc_bytes32* value)
+{
+    (void)context;
+    (void)address;
+    (void)key;
+    (void)value;
+    return ZVMC_STORAGE_ASSIGNED;
+}
+
+static zvmc_uint256be warmup_get_balance(struct zvmc_host_context* context,
+                                         const zvmc_address* address)
+{
+    return warmup_get_storage(context, address, NULL);
+}
+
+static size_t warmup_get_code_size(struct zvmc_host_context* context, const zvmc_address* address)
+{
+    (void)context;
+    (void)address;
+    return 0;
+}
+
+static zvmc_bytes32 warmup_get_code_hash(struct zvmc_host_context* context,
+                                         const zvmc_address* address)
+{
+    return warmup_get_storage(context, address, NULL);
+}
+
+static size_t warmup_copy_code(struct zvmc_host_context* context,
+                               const zvmc_address* address,
+                               size_t code_offset,
+                               uint8_t* buffer_data,
+                               size_t buffer_size)
+{
+    (void)code_offset;
+    (void)buffer_data;
+    (void)buffer_size;
+    return warmup_get_code_size(context, address);
+}
+
+static struct zvmc_result warmup_call(struct zvmc_host_context* context,
+                                      const struct zvmc_message* msg)
+{
+    (void)context;
+    (void)msg;
+    return zvmc_make_result(ZVMC_FAILURE, 0, 0, NULL, 0);
+}
+
+static struct zvmc_tx_context warmup_get_tx_context(struct zvmc_host_context* context)
+{
+    (void)context;
+    struct zvmc_tx_context tx_context;
+    memset(&tx_context, 0, sizeof(tx_context));
+    return tx_context;
+}
+
+static zvmc_bytes32 warmup_get_block_hash(struct zvmc_host_context* context, int64_t number)
+{
+    (void)number;
+    return warmup_get_storage(context, NULL, NULL);
+}
+
+static void warmup_emit_log(struct zvmc_host_context* context,
+                            const zvmc_address* address,
+                            const uint8_t* data,
+                            size_t data_size,
+                            const zvmc_bytes32 topics[],
+                            size_t topics_count)
+{
+    (void)context;
+    (void)address;
+    (void)data;
+    (void)data_size;
+    (void)topics;
+    (void)topics_count;
+}
+
+static enum zvmc_access_status warmup_access_account(struct zvmc_host_context* context,
+                                                     const zvmc_address* address)
+{
+    (void)context;
+    (void)address;
+    return ZVMC_ACCESS_COLD;
+}
+
+static enum zvmc_access_status warmup_access_storage(struct zvmc_host_context* context,
+                                                     const zvmc_address* address,
+                                                     const zvmc_bytes32* key)
+{
+    (void)key;
+    return warmup_access_account(context, address);
+}
+
+static const struct zvmc_host_interface warmup_host = {
+    warmup_account_exists, warmup_get_storage,     warmup_set_storage,    warmup_get_balance,
+    warmup_get_code_size,  warmup_get_code_hash,   warmup_copy_code,      warmup_call,
+    warmup_get_tx_context, warmup_get_block_hash,  warmup_emit_log,       warmup_access_account,
+    warmup_access_storage,
+};
+
+/// The loading of a single VM by zvmc_load_many().
+struct load_task
+{
+    const char* config;
+    struct zvmc_vm* vm;
+    enum zvmc_loader_error_code ec;
+    char error_msg[LAST_ERROR_MSG_BUFFER_SIZE + 1];
+};
+
+/// The tasks of zvmc_load_many() shared by the worker threads.
+struct load_queue
+{
+    struct load_task* tasks;
+    size_t count;
+    const struct zvmc_warmup* warmup;
+    ATOMIC_INDEX next;  ///< The index of the next task to take.
+};
+
+static void run_load_task(struct load_task* task, const struct zvmc_warmup* warmup)
+{
+    task->vm = zvmc_load_and_configure_r(task->config, &task->ec, task->error_msg,
+                                         sizeof(task->error_msg));
+
+    if (task->vm && warmup)
+    {
+        struct zvmc_message msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.kind = ZVMC_CALL;
+        msg.gas = warmup->gas;
+        msg.input_data = warmup->input;
+        msg.input_size = warmup->input_size;
+        for (int i = 0; i < warmup->iterations; ++i)
+        {
+            struct zvmc_result result = zvmc_execute(task->vm, &warmup_host, NULL, warmup->revision,
+                                                     &msg, warmup->code, warmup->code_size);
+            zvmc_release_result(&result);
+        }
+    }
+}
+
+/// Runs the tasks from the queue until all of them are taken.
+static THREAD_RETURN run_load_worker(void* arg)
+{
+    struct load_queue* queue = (struct load_queue*)arg;
+    while (1)
+    {
+        const size_t i = (size_t)ATOMIC_FETCH_INC(&queue->next);
+        if (i >= queue->count)
+            break;
+        run_load_task(&queue->tasks[i], queue->warmup);
+    }
+    return 0;
+}
+
+/// Returns the number of the available CPUs, at least 1.
+static size_t get_num_cpus(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    const long n = (long)info.dwNumberOfProcessors;
+#else
+    const long n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return n > 0 ? (size_t)n : 1;
+}
+
+size_t zvmc_load_many(const char* const* configs,
+                      size_t count,
+                      const struct zvmc_warmup* warmup,
+                      struct zvmc_vm** vms,
+                      enum zvmc_loader_error_code* error_codes)
+{
+    last_error_msg = NULL;  // Reset last error.
+
+    // The calling thread is also a worker.
+    const size_t num_cpus = get_num_cpus();
+    const size_t num_threads = (count < num_cpus ? count : num_cpus) - (count != 0);
+
+    struct load_task* tasks = calloc(count, sizeof(*tasks));
+    THREAD_HANDLE* threads = calloc(num_threads, sizeof(*threads));
+    bool* started = calloc(num_threads, sizeof(*started));
+    if ((count != 0 && !tasks) || (num_threads != 0 && (!threads || !started)))
+    {
+        free(tasks);
+        free(threads);
+        free(started);
+        set_error(ZVMC_LOADER_UNSPECIFIED_ERROR, "out of memory");
+        for (size_t i = 0; i < count; ++i)
+        {
+            vms[i] = NULL;
+            if (error_codes)
+                error_codes[i] = ZVMC_LOADER_UNSPECIFIED_ERROR;
+        }
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        tasks[i].config = configs[i];
+
+    struct load_queue queue = {tasks, count, warmup, 0};
+    for (size_t i = 0; i < num_threads; ++i)
+        started[i] = THREAD_START(&threads[i], run_load_worker, &queue);
+
+    // If the threads could not be started, the remaining tasks are run in this thread.
+    run_load_worker(&queue);
+    for (size_t i = 0; i < num_threads; ++i)
+    {
+        if (started[i])
+            THREAD_JOIN(threads[i]);
+    }
+
+    size_t num_loaded = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        vms[i] = tasks[i].vm;
+        if (error_codes)
+            error_codes[i] = tasks[i].ec;
+        if (tasks[i].vm)
+            ++num_loaded;
+        else if (!last_error_msg && tasks[i].error_msg[0] != 0)
+            set_error(tasks[i].ec, "%s", tasks[i].error_msg);
+    }
+
+    free(tasks);
+    free(threads);
+    free(started);
+    return num_loaded;
+}
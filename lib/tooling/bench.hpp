@@ -0,0 +1,45 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+
+namespace zvmc::tooling
+{
+/// The clock used by all benchmarks.
+using clock = std::chrono::steady_clock;
+
+/// The result of the benchmark loop.
+struct BenchResult
+{
+    /// The average time of a single iteration.
+    clock::duration time;
+
+    /// The number of iterations performed.
+    int num_iterations;
+};
+
+/// Repeats the @p fn @p num_iterations times and returns the average time of a single iteration.
+template <typename Fn>
+clock::duration bench_batch(int num_iterations, Fn&& fn)
+{
+    const auto start = clock::now();
+    for (int i = 0; i < num_iterations; ++i)
+        fn();
+    return (clock::now() - start) / num_iterations;
+}
+
+/// Repeats the @p fn for approximately the @p target_time.
+///
+/// The number of iterations is estimated from the @p probe_time of a single previous run,
+/// but at least one iteration is always performed.
+template <typename Fn>
+BenchResult bench_loop(clock::duration probe_time, clock::duration target_time, Fn&& fn)
+{
+    const auto num_iterations =
+        std::max(static_cast<int>(target_time / std::max(probe_time, clock::duration{1})), 1);
+    return {bench_batch(num_iterations, fn), num_iterations};
+}
+}  // namespace zvmc::tooling
@@ -0,0 +1,121 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include "bench.hpp"
+#include <zvmc/hex.hpp>
+#include <zvmc/mocked_host.hpp>
+#include <zvmc/tooling.hpp>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace zvmc::tooling
+{
+int bench_corpus(VM& vm,
+                 zvmc_revision rev,
+                 int64_t gas,
+                 const std::string& dir,
+                 std::chrono::milliseconds time,
+                 std::ostream& out)
+{
+    std::vector<fs::path> contracts;
+    for (const auto& entry : fs::directory_iterator{dir})
+    {
+        if (entry.is_directory())
+            contracts.emplace_back(entry.path());
+    }
+    std::sort(contracts.begin(), contracts.end());
+
+    out << "Benchmarking " << contracts.size() << " contracts on " << rev << " with " << gas
+        << " gas limit\n\n";
+
+    auto num_failures = 0;
+    auto log_time_sum = 0.0;
+    for (const auto& contract : contracts)
+    {
+        const auto name = contract.filename().string();
+        const auto code_file = contract / "code.hex";
+        const auto input_file = contract / "input.hex";
+        const auto expected_file = contract / "expected.hex";
+
+        // A fixture which cannot be loaded fails, the other contracts are still benchmarked.
+        bytes code;
+        bytes input;
+        std::optional<bytes> expected_output;
+        try
+        {
+            code = load_hex_file(code_file.string());
+            if (fs::exists(input_file))
+                input = load_hex_file(input_file.string());
+            if (fs::exists(expected_file))
+                expected_output = load_hex_file(expected_file.string());
+        }
+        catch (const std::invalid_argument& e)
+        {
+            ++num_failures;
+            out << name << ": FAILED (" << e.what() << ")\n";
+            continue;
+        }
+
+        MockedHost host;
+        zvmc_message msg{};
+        msg.gas = gas;
+        msg.input_data = input.data();
+        msg.input_size = input.size();
+
+        const auto result = vm.execute(host, rev, msg, code.data(), code.size());
+
+        const auto output = bytes_view{result.output_data, result.output_size};
+        out << name << ": " << result.status_code << ", gas used: " << (gas - result.gas_left);
+        if (result.status_code != ZVMC_SUCCESS ||
+            (expected_output.has_value() && output != *expected_output))
+        {
+            ++num_failures;
+            out << ", FAILED (output: " << hex(output) << ")\n";
+            continue;
+        }
+
+        // Every run starts from the empty host state, as the checked execution above did:
+        // the storage and the account access statuses do not drift between the runs
+        // and the records of the host do not grow.
+        const auto execute = [&] {
+            host.accounts.clear();
+            host.recorded_account_accesses.clear();
+            host.recorded_logs.clear();
+            host.recorded_blockhashes.clear();
+            vm.execute(host, rev, msg, code.data(), code.size());
+        };
+
+        // Probe run: execute once again the already warm code to estimate a single run time.
+        const auto probe_start = clock::now();
+        execute();
+        const auto probe_time = clock::now() - probe_start;
+
+        const auto [bench_time, num_iterations] = bench_loop(probe_time, time, execute);
+        const auto ns = std::chrono::duration<double, std::nano>{bench_time}.count();
+        log_time_sum += std::log(std::max(ns, 1.0));
+
+        out << ", time: " << static_cast<int64_t>(ns) << " ns (avg of " << num_iterations
+            << " iterations)\n";
+    }
+
+    const auto num_benchmarked = contracts.size() - static_cast<size_t>(num_failures);
+    if (num_benchmarked != 0)
+    {
+        const auto geomean = std::exp(log_time_sum / static_cast<double>(num_benchmarked));
+        out << "\nGeometric mean: " << static_cast<int64_t>(geomean) << " ns (" << num_benchmarked
+            << " contracts)\n";
+    }
+    if (num_failures != 0)
+        out << "Failed: " << num_failures << " contracts\n";
+
+    return num_failures == 0 ? 0 : 1;
+}
+}  // namespace zvmc::tooling
@@ -0,0 +1,253 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include "bench.hpp"
+#include <zvmc/instructions.h>
+#include <zvmc/mocked_host.hpp>
+#include <zvmc/tooling.hpp>
+#include <cstdio>
+#include <ostream>
+
+namespace zvmc::tooling
+{
+namespace
+{
+/// The number of repetitions of the instruction in the loop body.
+constexpr size_t num_repetitions = 16;
+
+/// The number of iterations of the loop.
+constexpr size_t num_iterations = 64;
+
+/// The number of stack items removed by the program measuring the cost of the sink.
+constexpr size_t num_sink_items = 512;
+
+/// The gas limit of the calibration program execution, high enough for any instruction.
+constexpr int64_t gas_limit = 100000000;
+
+/// Appends the removal of the top stack item.
+///
+/// The POP is used if the VM supports it. Otherwise, the item is consumed as the condition
+/// of the JUMPI to the JUMPDEST directly following it, so the execution continues there
+/// independently of the item value.
+void append_sink(bytes& code, bool has_pop)
+{
+    if (has_pop)
+    {
+        code.push_back(OP_POP);
+        return;
+    }
+    const auto dest = code.size() + 4;
+    code += {OP_PUSH2, static_cast<uint8_t>(dest >> 8), static_cast<uint8_t>(dest), OP_JUMPI,
+             OP_JUMPDEST};
+}
+
+/// Appends the instruction with the stack setup: the pushes of the arguments (zeros),
+/// the instruction and the sinks of its results.
+///
+/// In the @p baseline the instruction is omitted and the arguments are removed instead
+/// of the results. The jumps go to the JUMPDEST directly following them, the JUMPI condition
+/// is 1. The JUMPDEST is also kept in the baseline.
+void append_instruction(
+    bytes& code, uint8_t opcode, const zvmc_instruction_info& info, bool baseline, bool has_pop)
+{
+    const auto is_jump = opcode == OP_JUMP || opcode == OP_JUMPI;
+    if (is_jump)
+    {
+        if (opcode == OP_JUMPI)
+            code += {OP_PUSH1, 1};
+        const auto dest = code.size() + 4;
+        code += {OP_PUSH2, static_cast<uint8_t>(dest >> 8), static_cast<uint8_t>(dest)};
+    }
+    else
+    {
+        for (int j = 0; j < info.stack_height_required; ++j)
+            code += {OP_PUSH1, 0};
+    }
+
+    auto num_items = info.stack_height_required;
+    if (!baseline)
+    {
+        code.push_back(opcode);
+        code.append(info.immediate_size, 0);
+        num_items += info.stack_height_change;
+    }
+    for (int j = 0; j < num_items; ++j)
+        append_sink(code, has_pop);
+
+    if (is_jump)
+        code.push_back(OP_JUMPDEST);
+}
+
+/// Generates the loop executing the instruction num_repetitions times in every iteration.
+///
+/// The loop counter is kept on the stack and decremented by adding -1, so the loop only
+/// needs the PUSH, ADD, DUP1, JUMPI and JUMPDEST instructions.
+bytes make_program(uint8_t opcode, const zvmc_instruction_info& info, bool baseline, bool has_pop)
+{
+    constexpr uint8_t loop_begin = 3;
+    bytes code{OP_PUSH2, static_cast<uint8_t>(num_iterations >> 8),
+               static_cast<uint8_t>(num_iterations), OP_JUMPDEST};
+    for (size_t i = 0; i < num_repetitions; ++i)
+        append_instruction(code, opcode, info, baseline, has_pop);
+    code.push_back(OP_PUSH32);
+    code.append(32, 0xff);
+    code += {OP_ADD, OP_DUP1, OP_PUSH1, loop_begin, OP_JUMPI, OP_STOP};
+    return code;
+}
+
+/// Generates the program pushing num_sink_items zeros and then, if @p with_sinks,
+/// removing them.
+bytes make_sink_program(bool with_sinks, bool has_pop)
+{
+    bytes code;
+    for (size_t i = 0; i < num_sink_items; ++i)
+        code += {OP_PUSH1, 0};
+    for (size_t i = 0; with_sinks && i < num_sink_items; ++i)
+        append_sink(code, has_pop);
+    code.push_back(OP_STOP);
+    return code;
+}
+
+/// The measurement of a program execution.
+struct Measurement
+{
+    /// The execution status code. The other fields are only set in case of success.
+    zvmc_status_code status_code = ZVMC_SUCCESS;
+
+    /// The gas used.
+    double gas = 0;
+
+    /// The execution time in nanoseconds.
+    double ns = 0;
+};
+
+/// Executes the program once and, if it succeeds, benchmarks it for approximately the @p time.
+Measurement measure(VM& vm, zvmc_revision rev, bytes_view code, std::chrono::milliseconds time)
+{
+    MockedHost host;
+    zvmc_message msg{};
+    msg.gas = gas_limit;
+
+    const auto result = vm.execute(host, rev, msg, code.data(), code.size());
+    if (result.status_code != ZVMC_SUCCESS)
+        return {result.status_code};
+
+    // The host records the logs and the block hash queries of every execution.
+    const auto execute = [&] {
+        host.recorded_logs.clear();
+        host.recorded_blockhashes.clear();
+        vm.execute(host, rev, msg, code.data(), code.size());
+    };
+
+    // Probe run: execute once again the already warm code to estimate a single run time.
+    const auto probe_start = clock::now();
+    execute();
+    const auto probe_time = clock::now() - probe_start;
+
+    const auto bench_time = bench_loop(probe_time, time, execute).time;
+    return {ZVMC_SUCCESS, static_cast<double>(gas_limit - result.gas_left),
+            std::chrono::duration<double, std::nano>{bench_time}.count()};
+}
+
+/// Formats the measurement with the fixed precision, so the reports can be diffed.
+std::string format(double value)
+{
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.3f", value);
+    return buffer;
+}
+
+/// Escapes the string for the JSON output.
+std::string escape(const char* str)
+{
+    std::string escaped;
+    for (; *str != '\0'; ++str)
+    {
+        if (*str == '"' || *str == '\\')
+            escaped += '\\';
+        escaped += *str;
+    }
+    return escaped;
+}
+}  // namespace
+
+int calibrate(VM& vm, zvmc_revision rev, std::chrono::milliseconds time, std::ostream& out)
+{
+    const auto* info_table = zvmc_get_instruction_info_table(rev);
+    const auto* names_table = zvmc_get_instruction_names_table(rev);
+    if (info_table == nullptr || names_table == nullptr)
+    {
+        out << "Calibration not supported on " << rev << "\n";
+        return 1;
+    }
+
+    // The cost of the sink is measured, so the differences of the stack setup between
+    // the instruction program and its baseline can be subtracted.
+    MockedHost probe_host;
+    zvmc_message probe_msg{};
+    probe_msg.gas = gas_limit;
+    const uint8_t pop_probe[] = {OP_PUSH1, 0, OP_POP, OP_STOP};
+    const auto has_pop = vm.execute(probe_host, rev, probe_msg, pop_probe, sizeof(pop_probe))
+                             .status_code == ZVMC_SUCCESS;
+    const auto pushes = measure(vm, rev, make_sink_program(false, has_pop), time);
+    const auto sinks = measure(vm, rev, make_sink_program(true, has_pop), time);
+    if (pushes.status_code != ZVMC_SUCCESS || sinks.status_code != ZVMC_SUCCESS)
+    {
+        out << "Calibration failed: the VM cannot execute the stack setup: "
+            << (pushes.status_code != ZVMC_SUCCESS ? pushes.status_code : sinks.status_code)
+            << "\n";
+        return 1;
+    }
+    const auto sink_gas = (sinks.gas - pushes.gas) / num_sink_items;
+    const auto sink_ns = (sinks.ns - pushes.ns) / num_sink_items;
+
+    constexpr auto total_repetitions = num_repetitions * num_iterations;
+    out << "{\n"
+        << "  \"vm\": \"" << escape(vm.name()) << "\",\n"
+        << "  \"version\": \"" << escape(vm.version()) << "\",\n"
+        << "  \"revision\": \"" << rev << "\",\n"
+        << "  \"repetitions\": " << total_repetitions << ",\n"
+        << "  \"sink\": \"" << (has_pop ? "POP" : "JUMPI") << "\",\n"
+        << "  \"opcodes\": [";
+
+    auto first = true;
+    for (int op = 0; op < 256; ++op)
+    {
+        // The terminators cannot be repeated in a single program.
+        const auto& info = info_table[op];
+        if ((info.flags & ZVMC_INSTRUCTION_DEFINED) == 0 ||
+            (info.flags & ZVMC_INSTRUCTION_TERMINATOR) != 0)
+            continue;
+
+        const auto opcode = static_cast<uint8_t>(op);
+        const auto program = measure(vm, rev, make_program(opcode, info, false, has_pop), time);
+        const auto baseline =
+            program.status_code == ZVMC_SUCCESS ?
+                measure(vm, rev, make_program(opcode, info, true, has_pop), time) :
+                program;
+
+        char opcode_hex[8];
+        std::snprintf(opcode_hex, sizeof(opcode_hex), "0x%02x", op);
+        out << (first ? "\n" : ",\n") << "    {\"opcode\": \"" << opcode_hex << "\", \"name\": \""
+            << names_table[op] << "\", \"status\": \"" << baseline.status_code << "\"";
+        first = false;
+        if (baseline.status_code != ZVMC_SUCCESS)
+        {
+            out << "}";
+            continue;
+        }
+
+        // The baseline removes the arguments instead of the results of the instruction,
+        // so it differs by the stack height change number of sinks.
+        const auto change = info.stack_height_change;
+        const auto gas = (program.gas - baseline.gas) / total_repetitions - change * sink_gas;
+        const auto ns = (program.ns - baseline.ns) / total_repetitions - change * sink_ns;
+        out << ", \"gas\": " << format(gas) << ", \"ns\": " << format(ns)
+            << ", \"ns_per_gas\": " << format(gas != 0 ? ns / gas : 0) << "}";
+    }
+
+    out << "\n  ]\n}\n";
+    return 0;
+}
+}  // namespace zvmc::tooling
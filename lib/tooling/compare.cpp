@@ -0,0 +1,131 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include "bench.hpp"
+#include <zvmc/hex.hpp>
+#include <zvmc/mocked_host.hpp>
+#include <zvmc/tooling.hpp>
+#include <cmath>
+#include <ostream>
+
+namespace zvmc::tooling
+{
+namespace
+{
+/// The number of interleaved samples of each VM.
+constexpr auto num_samples = 30;
+
+/// The two-sided 95% quantile of the Student's t-distribution for num_samples - 1 degrees
+/// of freedom.
+constexpr auto t_quantile = 2.045;
+
+/// The approximate total time of the benchmark.
+constexpr auto target_bench_time = std::chrono::seconds{2};
+
+void print_result(const char* label, const Result& result, int64_t gas, std::ostream& out)
+{
+    out << label << ": " << result.status_code << ", gas used: " << (gas - result.gas_left)
+        << ", output: " << hex({result.output_data, result.output_size}) << "\n";
+}
+
+/// Executes the code on a fresh host and returns the average execution time of a batch.
+double measure(VM& vm,
+               zvmc_revision rev,
+               const zvmc_message& msg,
+               bytes_view code,
+               int batch_size)
+{
+    MockedHost host;
+    const auto time =
+        bench_batch(batch_size, [&] { vm.execute(host, rev, msg, code.data(), code.size()); });
+    return std::chrono::duration<double, std::nano>{time}.count();
+}
+}  // namespace
+
+int compare(VM& vm_a,
+            VM& vm_b,
+            zvmc_revision rev,
+            int64_t gas,
+            bytes_view code,
+            bytes_view input,
+            std::ostream& out)
+{
+    out << "Comparing on " << rev << " with " << gas << " gas limit\n"
+        << "A: " << vm_a.name() << " " << vm_a.version() << "\n"
+        << "B: " << vm_b.name() << " " << vm_b.version() << "\n\n";
+
+    zvmc_message msg{};
+    msg.gas = gas;
+    msg.input_data = input.data();
+    msg.input_size = input.size();
+
+    MockedHost host_a;
+    MockedHost host_b;
+    const auto result_a = vm_a.execute(host_a, rev, msg, code.data(), code.size());
+    const auto result_b = vm_b.execute(host_b, rev, msg, code.data(), code.size());
+
+    if (result_a.status_code != result_b.status_code || result_a.gas_left != result_b.gas_left ||
+        bytes_view{result_a.output_data, result_a.output_size} !=
+            bytes_view{result_b.output_data, result_b.output_size})
+    {
+        out << "Results mismatch\n";
+        print_result("A", result_a, gas, out);
+        print_result("B", result_b, gas, out);
+        return 1;
+    }
+
+    out << "Result:   " << result_a.status_code << "\nGas used: " << (gas - result_a.gas_left)
+        << "\n";
+    if (result_a.status_code == ZVMC_SUCCESS || result_a.status_code == ZVMC_REVERT)
+        out << "Output:   " << hex({result_a.output_data, result_a.output_size}) << "\n";
+
+    // Probe runs: execute once again the already warm code to estimate a single run time.
+    const auto probe_start = clock::now();
+    vm_a.execute(host_a, rev, msg, code.data(), code.size());
+    vm_b.execute(host_b, rev, msg, code.data(), code.size());
+    const auto probe_time = std::max((clock::now() - probe_start) / 2, clock::duration{1});
+    const auto sample_time = clock::duration{target_bench_time} / (2 * num_samples);
+    const auto batch_size = std::max(static_cast<int>(sample_time / probe_time), 1);
+
+    // Interleave the samples and alternate the order (ABBA) to cancel out the machine drift.
+    double sum_a = 0;
+    double sum_b = 0;
+    double sum_log_ratio = 0;
+    double sum_log_ratio_sq = 0;
+    for (int i = 0; i < num_samples; ++i)
+    {
+        double time_a = 0;
+        double time_b = 0;
+        if (i % 2 == 0)
+        {
+            time_a = measure(vm_a, rev, msg, code, batch_size);
+            time_b = measure(vm_b, rev, msg, code, batch_size);
+        }
+        else
+        {
+            time_b = measure(vm_b, rev, msg, code, batch_size);
+            time_a = measure(vm_a, rev, msg, code, batch_size);
+        }
+        sum_a += time_a;
+        sum_b += time_b;
+
+        const auto log_ratio = std::log(std::max(time_a, 1.0) / std::max(time_b, 1.0));
+        sum_log_ratio += log_ratio;
+        sum_log_ratio_sq += log_ratio * log_ratio;
+    }
+
+    // The speedup of B over A is the geometric mean of the per-sample time ratios.
+    const auto mean = sum_log_ratio / num_samples;
+    const auto variance =
+        std::max((sum_log_ratio_sq - num_samples * mean * mean) / (num_samples - 1), 0.0);
+    const auto margin = t_quantile * std::sqrt(variance / num_samples);
+
+    out << "\nTime A:   " << static_cast<int64_t>(sum_a / num_samples) << " ns\n"
+        << "Time B:   " << static_cast<int64_t>(sum_b / num_samples) << " ns\n"
+        << "Speedup:  " << std::exp(mean) << "x (95% CI: " << std::exp(mean - margin) << "x - "
+        << std::exp(mean + margin) << "x, " << num_samples << " samples of " << batch_size
+        << " iterations)\n";
+    return 0;
+}
+}  // namespace zvmc::tooling
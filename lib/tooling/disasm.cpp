@@ -0,0 +1,215 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include <zvmc/instructions.h>
+#include <zvmc/tooling.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace zvmc::tooling
+{
+namespace
+{
+/// The instruction tables of the revision.
+struct InstructionTables
+{
+    const zvmc_instruction_info* info;
+    const char* const* names;
+};
+
+/// Returns the instruction tables of the revision, null if the revision is not supported.
+InstructionTables get_instruction_tables(zvmc_revision rev) noexcept
+{
+    return {zvmc_get_instruction_info_table(rev), zvmc_get_instruction_names_table(rev)};
+}
+
+/// The hex digits of the opcodes and of the immediate data.
+constexpr char hex_digits[] = "0123456789abcdef";
+
+/// Writes the instruction name, or the opcode in hex if the instruction is undefined.
+char* write_name(char* p, const InstructionTables& tables, uint8_t opcode) noexcept
+{
+    const char* name = tables.names[opcode];
+    if (name == nullptr)
+    {
+        *p++ = '0';
+        *p++ = 'x';
+        *p++ = hex_digits[opcode >> 4];
+        *p++ = hex_digits[opcode & 0xf];
+        return p;
+    }
+    while (*name != '\0')
+        *p++ = *name++;
+    return p;
+}
+
+/// Calls the @p fn for every instruction of the code with the instruction offset, the opcode
+/// and the immediate data. The immediate data is truncated by the end of the code.
+template <typename Fn>
+void for_each_instruction(bytes_view code, const zvmc_instruction_info* info, Fn&& fn)
+{
+    for (size_t i = 0; i < code.size();)
+    {
+        const auto opcode = code[i];
+        const auto immediate = code.substr(i + 1, info[opcode].immediate_size);
+        fn(i, opcode, immediate);
+        i += 1 + immediate.size();
+    }
+}
+
+/// The histogram of the instruction sequences.
+///
+/// The sequence of opcodes is the key of the histogram, the first opcode in the most
+/// significant byte.
+class Histogram
+{
+    std::unordered_map<uint32_t, uint64_t> m_counts;
+    uint64_t m_total = 0;
+
+public:
+    /// The number of the sequences added.
+    uint64_t total() const noexcept { return m_total; }
+
+    /// Adds the sequence.
+    void add(uint32_t key)
+    {
+        ++m_counts[key];
+        ++m_total;
+    }
+
+    /// Prints the @p top most frequent sequences of the @p length.
+    void print(const char* title,
+               size_t length,
+               size_t top,
+               const InstructionTables& tables,
+               std::ostream& out) const
+    {
+        std::vector<std::pair<uint32_t, uint64_t>> entries{m_counts.begin(), m_counts.end()};
+        const auto num_entries = std::min(top, entries.size());
+        // The most frequent first, the ties in the opcode order.
+        const auto by_count = [](const auto& a, const auto& b) {
+            return a.second != b.second ? a.second > b.second : a.first < b.first;
+        };
+        std::partial_sort(entries.begin(), entries.begin() + static_cast<ptrdiff_t>(num_entries),
+                          entries.end(), by_count);
+
+        out << "\n" << title << ":\n";
+        for (size_t i = 0; i < num_entries; ++i)
+        {
+            const auto [key, count] = entries[i];
+            char line[128];
+            auto* p = line + std::snprintf(line, sizeof(line), "%12llu %6.2f%% ",
+                                           static_cast<unsigned long long>(count),
+                                           100.0 * static_cast<double>(count) /
+                                               static_cast<double>(m_total));
+            for (size_t j = length; j > 0; --j)
+            {
+                *p++ = ' ';
+                p = write_name(p, tables, static_cast<uint8_t>(key >> ((j - 1) * 8)));
+            }
+            *p++ = '\n';
+            out.write(line, p - line);
+        }
+    }
+};
+}  // namespace
+
+int disasm(zvmc_revision rev, bytes_view code, std::ostream& out)
+{
+    const auto tables = get_instruction_tables(rev);
+    if (tables.info == nullptr || tables.names == nullptr)
+    {
+        out << "Disassembly not supported on " << rev << "\n";
+        return 1;
+    }
+
+    // The longest line is the offset, PUSH32 with 32 bytes of data and the truncation note.
+    char line[128];
+    for_each_instruction(code, tables.info, [&](size_t offset, uint8_t opcode, bytes_view data) {
+        auto* p = line + std::snprintf(line, sizeof(line), "%6zu  ", offset);
+        p = write_name(p, tables, opcode);
+        if (tables.info[opcode].immediate_size != 0)
+        {
+            *p++ = ' ';
+            *p++ = '0';
+            *p++ = 'x';
+            for (const auto b : data)
+            {
+                *p++ = hex_digits[b >> 4];
+                *p++ = hex_digits[b & 0xf];
+            }
+            if (data.size() != tables.info[opcode].immediate_size)
+            {
+                constexpr std::string_view note = " (truncated)";
+                p = std::copy(note.begin(), note.end(), p);
+            }
+        }
+        *p++ = '\n';
+        out.write(line, p - line);
+    });
+    return 0;
+}
+
+int stats(zvmc_revision rev, const std::string& dir, size_t top, std::ostream& out)
+{
+    const auto tables = get_instruction_tables(rev);
+    if (tables.info == nullptr || tables.names == nullptr)
+    {
+        out << "Statistics not supported on " << rev << "\n";
+        return 1;
+    }
+
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::recursive_directory_iterator{dir})
+    {
+        const auto& path = entry.path();
+        if (entry.is_regular_file() &&
+            (path.extension() == ".bin" || path.filename() == "code.hex"))
+            files.emplace_back(path);
+    }
+    std::sort(files.begin(), files.end());
+
+    Histogram opcodes;
+    Histogram pairs;
+    Histogram triples;
+    for (const auto& path : files)
+    {
+        // The binary files are memory-mapped, only the hex files are decoded.
+        MappedFile file;
+        bytes decoded;
+        if (path.extension() == ".bin")
+            file = MappedFile{path.string()};
+        else
+            decoded = load_hex_file(path.string());
+        const auto code = decoded.empty() ? file.data() : bytes_view{decoded};
+
+        // The opcodes of the previous instructions of the file, the number of them is limited
+        // by the sequence length.
+        uint32_t sequence = 0;
+        size_t sequence_length = 0;
+        for_each_instruction(code, tables.info, [&](size_t, uint8_t opcode, bytes_view) {
+            sequence = ((sequence << 8) | opcode) & 0xffffff;
+            sequence_length = std::min(sequence_length + 1, size_t{3});
+            opcodes.add(opcode);
+            if (sequence_length >= 2)
+                pairs.add(sequence & 0xffff);
+            if (sequence_length == 3)
+                triples.add(sequence);
+        });
+    }
+
+    out << "Analyzed " << files.size() << " files, " << opcodes.total() << " instructions\n";
+    opcodes.print("Opcodes", 1, top, tables, out);
+    pairs.print("Pairs", 2, top, tables, out);
+    triples.print("Triples", 3, top, tables, out);
+    return 0;
+}
+}  // namespace zvmc::tooling
@@ -0,0 +1,101 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include <zvmc/hex.hpp>
+#include <zvmc/tooling.hpp>
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#include <fstream>
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace zvmc::tooling
+{
+#if defined(_WIN32)
+MappedFile::MappedFile(const std::string& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+        throw std::invalid_argument{"cannot open " + path};
+    m_buffer.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+}
+
+MappedFile::~MappedFile() noexcept = default;
+#else
+MappedFile::MappedFile(const std::string& path)
+{
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::invalid_argument{"cannot open " + path};
+
+    struct stat st
+    {
+    };
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+    {
+        close(fd);
+        throw std::invalid_argument{"cannot open " + path};
+    }
+
+    // Empty files cannot be mapped, the default empty view is used instead.
+    if (st.st_size != 0)
+    {
+        const auto size = static_cast<size_t>(st.st_size);
+        auto* const p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            throw std::invalid_argument{"cannot map " + path};
+        }
+        madvise(p, size, MADV_SEQUENTIAL);
+        m_data = static_cast<const uint8_t*>(p);
+        m_size = size;
+    }
+    close(fd);  // The mapping stays valid after closing the file.
+}
+
+MappedFile::~MappedFile() noexcept
+{
+    if (m_data != nullptr)
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+}
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+  : m_data{std::exchange(other.m_data, nullptr)},
+    m_size{std::exchange(other.m_size, 0)},
+    m_buffer{std::move(other.m_buffer)}
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    // The previous mapping is released by the destructor of the other.
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    m_buffer.swap(other.m_buffer);
+    return *this;
+}
+
+bytes load_hex_file(const std::string& path)
+{
+    const MappedFile file{path};
+    const auto data = file.data();
+
+    bytes out(spaced_hex_decoder::max_decoded_size(data.size()), 0);
+    spaced_hex_decoder decoder;
+    const auto size =
+        decoder.decode({reinterpret_cast<const char*>(data.data()), data.size()}, out.data());
+    if (!size || !decoder.finish())
+        throw std::invalid_argument{"invalid hex in " + path};
+    out.resize(*size);
+    return out;
+}
+}  // namespace zvmc::tooling
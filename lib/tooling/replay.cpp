@@ -0,0 +1,119 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include "bench.hpp"
+#include <zvmc/hex.hpp>
+#include <zvmc/recording_host.hpp>
+#include <zvmc/tooling.hpp>
+#include <zvmc/trace.hpp>
+#include <memory>
+#include <ostream>
+
+namespace zvmc::tooling
+{
+namespace
+{
+/// The target time of the replay benchmark.
+constexpr auto target_bench_time = std::chrono::seconds{1};
+
+Result execute(VM& vm, ReplayHost& host, const TracedMessage& message)
+{
+    auto msg = message.msg;
+    msg.input_data = message.input.data();
+    msg.input_size = message.input.size();
+    host.rewind();
+    return vm.execute(host, message.rev, msg, message.code.data(), message.code.size());
+}
+
+void print_result(const char* label,
+                  zvmc_status_code status_code,
+                  int64_t gas_used,
+                  bytes_view output,
+                  int64_t gas_refund,
+                  const address& create_address,
+                  std::ostream& out)
+{
+    const bytes_view create_address_bytes{create_address.bytes, sizeof(create_address.bytes)};
+    out << "  " << label << status_code << ", gas used: " << gas_used
+        << ", output: " << hex(output) << ", gas refund: " << gas_refund
+        << ", create address: " << hex(create_address_bytes) << "\n";
+}
+}  // namespace
+
+int replay(VM& vm, const Trace& trace, bool bench, std::ostream& out)
+{
+    out << "Replaying " << trace.messages.size() << " messages\n";
+
+    // Every message is served by the Host replaying its recorded Host calls.
+    std::vector<std::unique_ptr<ReplayHost>> hosts;
+    hosts.reserve(trace.messages.size());
+    for (const auto& message : trace.messages)
+        hosts.emplace_back(std::make_unique<ReplayHost>(message.host_calls));
+
+    int num_failed = 0;
+    for (size_t i = 0; i < trace.messages.size(); ++i)
+    {
+        const auto& message = trace.messages[i];
+        const auto& expected = message.result;
+        auto& host = *hosts[i];
+        const auto result = execute(vm, host, message);
+        const auto gas = message.msg.gas;
+        const bytes_view output{result.output_data, result.output_size};
+
+        out << "Message " << i << ": " << result.status_code
+            << ", gas used: " << (gas - result.gas_left);
+        const auto result_matches =
+            result.status_code == expected.status_code && result.gas_left == expected.gas_left &&
+            output == expected.output && result.gas_refund == expected.gas_refund &&
+            result.create_address == expected.create_address;
+        if (result_matches && host.finished())
+        {
+            out << "\n";
+            continue;
+        }
+
+        ++num_failed;
+        out << ", FAILED\n";
+        if (!result_matches)
+        {
+            print_result("expected: ", expected.status_code, gas - expected.gas_left,
+                         expected.output, expected.gas_refund, expected.create_address, out);
+            print_result("got:      ", result.status_code, gas - result.gas_left, output,
+                         result.gas_refund, result.create_address, out);
+        }
+        if (!host.finished())
+            out << "  the Host calls do not match the recorded ones\n";
+    }
+
+    if (num_failed != 0)
+    {
+        out << "Failed: " << num_failed << " mismatches\n";
+        return 1;
+    }
+
+    if (bench)
+    {
+        // The replay Hosts are rewound before every execution.
+        const auto replay_once = [&] {
+            const auto start = clock::now();
+            for (size_t i = 0; i < trace.messages.size(); ++i)
+                execute(vm, *hosts[i], trace.messages[i]);
+            return clock::now() - start;
+        };
+
+        const auto probe_time = std::max(replay_once(), clock::duration{1});
+        const auto num_iterations =
+            std::max(static_cast<int>(target_bench_time / probe_time), 1);
+        clock::duration total_time{};
+        for (int i = 0; i < num_iterations; ++i)
+            total_time += replay_once();
+
+        out << "Time:     "
+            << std::chrono::duration_cast<std::chrono::nanoseconds>(total_time / num_iterations)
+                   .count()
+            << " ns (avg of " << num_iterations << " iterations)\n";
+    }
+    return 0;
+}
+}  // namespace zvmc::tooling
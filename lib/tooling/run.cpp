@@ -2,6 +2,7 @@
 // Copyright 2019-2020 The EVMC Authors.
 // Licensed under the Apache License, Version 2.0.
 
+#include "bench.hpp"
 #include <zvmc/hex.hpp>
 #include <zvmc/mocked_host.hpp>
 #include <zvmc/tooling.hpp>
@@ -28,7 +29,6 @@ auto bench(MockedHost& host,
            std::ostream& out)
 {
     {
-        using clock = std::chrono::steady_clock;
         using unit = std::chrono::nanoseconds;
         constexpr auto unit_name = " ns";
         constexpr auto target_bench_time = std::chrono::seconds{1};
@@ -38,8 +38,7 @@ auto bench(MockedHost& host,
         // Probe run: execute once again the already warm code to estimate a single run time.
         const auto probe_start = clock::now();
         const auto result = vm.execute(host, rev, msg, code.data(), code.size());
-        const auto bench_start = clock::now();
-        const auto probe_time = bench_start - probe_start;
+        const auto probe_time = clock::now() - probe_start;
 
         if (result.gas_left != expected_result.gas_left)
             out << warning << "(gas used: " << (msg.gas - result.gas_left) << ")\n";
@@ -48,10 +47,9 @@ auto bench(MockedHost& host,
             out << warning << "(output: " << hex({result.output_data, result.output_size}) << ")\n";
 
         // Benchmark loop.
-        const auto num_iterations = std::max(static_cast<int>(target_bench_time / probe_time), 1);
-        for (int i = 0; i < num_iterations; ++i)
-            vm.execute(host, rev, msg, code.data(), code.size());
-        const auto bench_time = (clock::now() - bench_start) / num_iterations;
+        const auto [bench_time, num_iterations] =
+            bench_loop(probe_time, target_bench_time,
+                       [&] { vm.execute(host, rev, msg, code.data(), code.size()); });
 
         out << "Time:     " << std::chrono::duration_cast<unit>(bench_time).count() << unit_name
             << " (avg of " << num_iterations << " iterations)\n";
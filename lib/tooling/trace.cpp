@@ -0,0 +1,140 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include <zvmc/recording_host.hpp>
+#include <zvmc/trace.hpp>
+#include <algorithm>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+/// @file
+/// The binary trace format.
+///
+/// The trace uses the encoding of the Host call records (see recording_host.hpp): integers
+/// are 8-byte little-endian, addresses and 32-byte words are raw bytes and byte strings are
+/// prefixed with their length.
+///
+///     trace       = "ZVMT" version:byte(2) count:int message*
+///     message     = rev:int msg code:bytes host_calls:bytes result
+///     msg         = kind:int flags:int depth:int gas:int recipient:address sender:address
+///                   input:bytes value:word create2_salt:word code_address:address
+///     result      = status_code:int gas_left:int gas_refund:int output:bytes
+///                   create_address:address
+///
+/// The host_calls is the complete stream written by the RecordingHost during the execution.
+
+namespace zvmc
+{
+namespace
+{
+/// The header of the trace: the magic and the format version.
+constexpr uint8_t trace_header[] = {'Z', 'V', 'M', 'T', 2};
+
+/// The encoded size of the message with empty byte strings: the revision, the message
+/// fields, the code and the Host calls lengths and the result fields.
+constexpr size_t min_message_size = 8 + (4 * 8 + 2 * 20 + 8 + 2 * 32 + 20) + 8 + 8 +
+                                    (3 * 8 + 8 + 20);
+
+TracedResult to_traced_result(const zvmc_result& r)
+{
+    return {r.status_code, r.gas_left, r.gas_refund, {r.output_data, r.output_size},
+            r.create_address};
+}
+
+/// Returns the zvmc_result referencing the output of the traced result.
+zvmc_result to_result(const TracedResult& r) noexcept
+{
+    zvmc_result result{};
+    result.status_code = r.status_code;
+    result.gas_left = r.gas_left;
+    result.gas_refund = r.gas_refund;
+    result.output_data = r.output.data();
+    result.output_size = r.output.size();
+    result.create_address = r.create_address;
+    return result;
+}
+}  // namespace
+
+void write_trace(std::ostream& out, const Trace& trace)
+{
+    host_record::Writer w{out, host_record::Writer::default_buffer_size,
+                          {trace_header, sizeof(trace_header)}};
+    w.integer(trace.messages.size());
+    for (const auto& m : trace.messages)
+    {
+        auto msg = m.msg;
+        msg.input_data = m.input.data();
+        msg.input_size = m.input.size();
+
+        w.integer(static_cast<uint64_t>(m.rev));
+        w.message(msg);
+        w.data(m.code.data(), m.code.size());
+        w.data(m.host_calls.data(), m.host_calls.size());
+        w.result(to_result(m.result));
+    }
+}
+
+Trace read_trace(std::istream& in)
+{
+    const bytes data(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{});
+    const bytes_view header{trace_header, sizeof(trace_header)};
+    if (data.size() < header.size() || !std::equal(header.begin(), header.end() - 1, data.begin()))
+        throw std::invalid_argument{"invalid trace: bad magic"};
+    if (data[header.size() - 1] != header.back())
+        throw std::invalid_argument{"invalid trace: unsupported version"};
+
+    host_record::Reader r{data, header};
+    Trace trace;
+    const auto count = r.integer();
+    // Bound the number of messages by the input size before allocating them.
+    if (count > r.remaining() / min_message_size)
+        throw std::invalid_argument{"invalid trace: too many messages"};
+    trace.messages.resize(static_cast<size_t>(count));
+    for (auto& m : trace.messages)
+    {
+        m.rev = static_cast<zvmc_revision>(r.integer());
+        if (m.rev > ZVMC_MAX_REVISION)
+            throw std::invalid_argument{"invalid trace: invalid revision"};
+        m.msg = r.message();
+        m.input.assign(m.msg.input_data, m.msg.input_size);
+        m.msg.input_data = nullptr;
+        m.msg.input_size = 0;
+        m.code = r.data();
+        m.host_calls = r.data();
+        m.result = to_traced_result(r.result());
+    }
+
+    if (r.error())
+        throw std::invalid_argument{"invalid trace: unexpected end of input"};
+    if (!r.at_end())
+        throw std::invalid_argument{"invalid trace: unexpected data after the last message"};
+    return trace;
+}
+
+Result TraceRecorder::execute(VM& vm, zvmc_revision rev, const zvmc_message& msg, bytes_view code)
+{
+    auto& m = m_trace.messages.emplace_back();
+    m.rev = rev;
+    m.msg = msg;
+    m.msg.input_data = nullptr;
+    m.msg.input_size = 0;
+    if (msg.input_size != 0)
+        m.input.assign(msg.input_data, msg.input_size);
+    m.code = code;
+
+    // The recording is flushed to the stream when the RecordingHost is destroyed.
+    std::ostringstream host_calls;
+    auto result = [&] {
+        RecordingHost<HostInterface> recorder{m_host, host_calls};
+        return vm.execute(recorder, rev, msg, code.data(), code.size());
+    }();
+    const auto record = host_calls.str();
+    m.host_calls.assign(reinterpret_cast<const uint8_t*>(record.data()), record.size());
+    m.result = to_traced_result(result.raw());
+    return result;
+}
+}  // namespace zvmc
@@ -0,0 +1,264 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include <zvmc/analysis.hpp>
+#include <zvmc/instructions.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+
+using namespace zvmc;
+using namespace zvmc::literals;
+
+namespace
+{
+// 0:  PUSH1 5, JUMP
+// 3:  JUMPDEST, PUSH1 1, PUSH1 2, ADD
+// 9:  JUMPDEST, PUSH2 0x5b5b, ADD, STOP
+// 15: JUMPDEST, <undefined 0x0c>
+// 17: PUSH32 truncated after 2 bytes
+constexpr auto code = 0x6005565b60016002015b615b5b01005b0c7f0000_hex;
+
+/// The byte-at-a-time reference of zvmc_analyze_jumpdests().
+std::pair<bytes, bytes> analyze_jumpdests_reference(bytes_view input)
+{
+    bytes jumpdest_map((input.size() + 7) / 8, 0);
+    bytes push_data_map(jumpdest_map.size(), 0);
+    for (size_t i = 0; i < input.size(); ++i)
+    {
+        const auto op = input[i];
+        if (op == OP_JUMPDEST)
+            jumpdest_map[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+        else if (op >= OP_PUSH1 && op <= OP_PUSH32)
+        {
+            for (size_t j = 0; j < size_t{op} - OP_PUSH1 + 1 && i + 1 < input.size(); ++j)
+            {
+                ++i;
+                push_data_map[i / 8] |= static_cast<uint8_t>(1 << (i % 8));
+            }
+        }
+    }
+    return {jumpdest_map, push_data_map};
+}
+
+bool operator==(const zvmc_code_block& a, const zvmc_code_block& b) noexcept
+{
+    return a.begin == b.begin && a.end == b.end && a.gas_cost == b.gas_cost &&
+           a.stack_height_required == b.stack_height_required &&
+           a.stack_height_max_growth == b.stack_height_max_growth &&
+           a.stack_height_change == b.stack_height_change &&
+           a.stack_height_entry == b.stack_height_entry && a.stack_verdict == b.stack_verdict;
+}
+}  // namespace
+
+TEST(analysis, maps)
+{
+    const CodeAnalysis analysis{ZVMC_SHANGHAI, {code.data(), code.size()}};
+    ASSERT_EQ(analysis.code_size(), code.size());
+
+    const std::set<size_t> jumpdests{3, 9, 15};
+    const std::set<size_t> push_data{1, 5, 7, 11, 12, 18, 19};
+    for (size_t i = 0; i < code.size() + 8; ++i)
+    {
+        EXPECT_EQ(analysis.is_jumpdest(i), jumpdests.count(i) != 0) << i;
+        EXPECT_EQ(analysis.is_push_data(i), push_data.count(i) != 0) << i;
+    }
+}
+
+TEST(analysis, blocks)
+{
+    const CodeAnalysis analysis{ZVMC_SHANGHAI, {code.data(), code.size()}};
+
+    const zvmc_code_block expected[] = {
+        {0, 3, 3 + 8, 0, 1, 0, 0, ZVMC_STACK_VALID},
+        {3, 9, 1 + 3 + 3 + 3, 0, 2, 1, -1, ZVMC_STACK_CHECK_ENTRY},
+        {9, 15, 1 + 3 + 3 + 0, 1, 1, 0, -1, ZVMC_STACK_CHECK_ENTRY},
+        {15, 17, 1 + 0, 0, 0, 0, -1, ZVMC_STACK_CHECK_ENTRY},
+        {17, 20, 3, 0, 1, 1, -1, ZVMC_STACK_CHECK_ENTRY},
+    };
+    ASSERT_EQ(analysis.num_blocks(), std::size(expected));
+    size_t i = 0;
+    for (const auto& block : analysis)
+        EXPECT_TRUE(block == expected[i++]) << i;
+
+    EXPECT_EQ(analysis.find_block(0), analysis.begin());
+    EXPECT_EQ(analysis.find_block(2), analysis.begin());
+    EXPECT_EQ(analysis.find_block(3), analysis.begin() + 1);
+    EXPECT_EQ(analysis.find_block(14), analysis.begin() + 2);
+    EXPECT_EQ(analysis.find_block(19), analysis.begin() + 4);
+    EXPECT_EQ(analysis.find_block(20), nullptr);
+}
+
+TEST(analysis, stack_height)
+{
+    // POP, POP, PUSH1 0, DUP1, DUP1, ADD, SWAP2, JUMPI
+    constexpr auto c = 0x50506000808001915700_hex;
+    const CodeAnalysis analysis{ZVMC_SHANGHAI, {c.data(), c.size()}};
+    ASSERT_EQ(analysis.num_blocks(), 2u);
+    EXPECT_EQ(analysis.begin()->stack_height_required, 3);
+    EXPECT_EQ(analysis.begin()->stack_height_max_growth, 1);
+    EXPECT_EQ(analysis.begin()->end, 9u);
+}
+
+TEST(analysis, stack_verdicts)
+{
+    // 0:  PUSH1 1, PUSH1 9, JUMPI
+    // 5:  PUSH1 1, ADD, STOP
+    // 9:  JUMPDEST, POP, STOP
+    // 12: PUSH1 0
+    constexpr auto c = 0x6001600957600101005b50006000_hex;
+    const CodeAnalysis analysis{ZVMC_SHANGHAI, {c.data(), c.size()}};
+    ASSERT_EQ(analysis.num_blocks(), 4u);
+    const auto* blocks = analysis.begin();
+
+    EXPECT_EQ(blocks[0].stack_height_entry, 0);
+    EXPECT_EQ(blocks[0].stack_height_change, 0);
+    EXPECT_EQ(blocks[0].stack_verdict, ZVMC_STACK_VALID);
+
+    // The ADD underflows after the JUMPI fall-through.
+    EXPECT_EQ(blocks[1].stack_height_entry, 0);
+    EXPECT_EQ(blocks[1].stack_height_change, 0);
+    EXPECT_EQ(blocks[1].stack_verdict, ZVMC_STACK_INVALID);
+
+    // The jump destination.
+    EXPECT_EQ(blocks[2].stack_height_entry, -1);
+    EXPECT_EQ(blocks[2].stack_height_change, -1);
+    EXPECT_EQ(blocks[2].stack_verdict, ZVMC_STACK_CHECK_ENTRY);
+    EXPECT_FALSE(zvmc_check_block_stack(&blocks[2], 0));
+    EXPECT_TRUE(zvmc_check_block_stack(&blocks[2], 1));
+    EXPECT_TRUE(zvmc_check_block_stack(&blocks[2], ZVMC_STACK_LIMIT));
+
+    // The unreachable code after the STOP.
+    EXPECT_EQ(blocks[3].stack_height_entry, -1);
+    EXPECT_EQ(blocks[3].stack_verdict, ZVMC_STACK_CHECK_ENTRY);
+    EXPECT_TRUE(zvmc_check_block_stack(&blocks[3], ZVMC_STACK_LIMIT - 1));
+    EXPECT_FALSE(zvmc_check_block_stack(&blocks[3], ZVMC_STACK_LIMIT));
+}
+
+TEST(analysis, stack_height_propagation)
+{
+    // PUSH1 0, PUSH1 0, PUSH1 0, JUMPI, POP, STOP
+    constexpr auto c = 0x600060006000575000_hex;
+    const CodeAnalysis analysis{ZVMC_SHANGHAI, {c.data(), c.size()}};
+    ASSERT_EQ(analysis.num_blocks(), 2u);
+    EXPECT_EQ(analysis.begin()[0].stack_height_change, 1);
+    EXPECT_EQ(analysis.begin()[1].stack_height_entry, 1);
+    EXPECT_EQ(analysis.begin()[1].stack_verdict, ZVMC_STACK_VALID);
+
+    // The fall-through of the invalid block is not propagated.
+    constexpr auto underflow = 0x6000575000_hex;
+    const CodeAnalysis underflow_analysis{ZVMC_SHANGHAI, {underflow.data(), underflow.size()}};
+    ASSERT_EQ(underflow_analysis.num_blocks(), 2u);
+    EXPECT_EQ(underflow_analysis.begin()[0].stack_verdict, ZVMC_STACK_INVALID);
+    EXPECT_EQ(underflow_analysis.begin()[1].stack_height_entry, -1);
+
+    const bytes overflow(ZVMC_STACK_LIMIT + 1, OP_PUSH0);
+    const CodeAnalysis overflow_analysis{ZVMC_SHANGHAI, overflow};
+    ASSERT_EQ(overflow_analysis.num_blocks(), 1u);
+    EXPECT_EQ(overflow_analysis.begin()->stack_verdict, ZVMC_STACK_INVALID);
+    const CodeAnalysis full_analysis{ZVMC_SHANGHAI, {overflow.data(), ZVMC_STACK_LIMIT}};
+    EXPECT_EQ(full_analysis.begin()->stack_verdict, ZVMC_STACK_VALID);
+}
+
+TEST(analysis, jumpdest_at_block_start)
+{
+    // A JUMPDEST after a terminator does not create an empty block.
+    constexpr auto c = 0x005b5b00_hex;
+    const CodeAnalysis analysis{ZVMC_SHANGHAI, {c.data(), c.size()}};
+    ASSERT_EQ(analysis.num_blocks(), 3u);
+    EXPECT_EQ(analysis.begin()[0].end, 1u);
+    EXPECT_EQ(analysis.begin()[1].end, 2u);
+    EXPECT_EQ(analysis.begin()[2].end, 4u);
+    EXPECT_EQ(analysis.begin()[2].gas_cost, 1);
+}
+
+TEST(analysis, empty_code)
+{
+    auto* const analysis = zvmc_analyze_code(ZVMC_SHANGHAI, nullptr, 0);
+    ASSERT_NE(analysis, nullptr);
+    EXPECT_EQ(analysis->code_size, 0u);
+    EXPECT_EQ(analysis->num_blocks, 0u);
+    EXPECT_EQ(zvmc_find_code_block(analysis, 0), nullptr);
+    EXPECT_EQ(zvmc_is_jumpdest(analysis, 0), 0);
+    zvmc_free_code_analysis(analysis);
+    zvmc_free_code_analysis(nullptr);
+}
+
+TEST(analysis, invalid_revision)
+{
+    const auto rev = static_cast<zvmc_revision>(ZVMC_MAX_REVISION + 1);
+    EXPECT_EQ(zvmc_analyze_code(rev, code.data(), code.size()), nullptr);
+    EXPECT_THROW((CodeAnalysis{rev, {}}), std::invalid_argument);
+}
+
+TEST(analysis, every_opcode)
+{
+    // The blocks cover the whole code and the jumpdests are only outside of PUSH data.
+    bytes c;
+    for (int i = 0; i < 256; ++i)
+    {
+        c.push_back(static_cast<uint8_t>(i));
+        c.push_back(OP_JUMPDEST);
+    }
+    const CodeAnalysis analysis{ZVMC_SHANGHAI, c};
+    uint32_t end = 0;
+    for (const auto& block : analysis)
+    {
+        EXPECT_EQ(block.begin, end);
+        EXPECT_GT(block.end, block.begin);
+        end = block.end;
+    }
+    EXPECT_EQ(end, c.size());
+
+    for (size_t i = 0; i < c.size(); ++i)
+    {
+        if (analysis.is_jumpdest(i))
+        {
+            EXPECT_EQ(c[i], OP_JUMPDEST);
+            EXPECT_FALSE(analysis.is_push_data(i));
+        }
+    }
+}
+
+TEST(analysis, jumpdests_against_reference)
+{
+    std::mt19937 gen{42};  // NOLINT(cert-msc32-c,cert-msc51-cpp)
+    // The code being mostly PUSHes and JUMPDESTs exercises the PUSH data crossing chunks.
+    const uint8_t alphabet[] = {OP_JUMPDEST, OP_PUSH1, OP_PUSH2, OP_PUSH31, OP_PUSH32, OP_ADD};
+    std::uniform_int_distribution<size_t> pick{0, std::size(alphabet) - 1};
+    std::uniform_int_distribution<int> any_byte{0, 255};
+
+    const size_t sizes[] = {0, 1, 31, 63, 64, 65, 127, 128, 129, 200, 1000, 24576};
+    for (const auto size : sizes)
+    {
+        for (int dense = 0; dense < 2; ++dense)
+        {
+            bytes c(size + 1, 0);
+            for (auto& b : c)
+                b = dense ? alphabet[pick(gen)] : static_cast<uint8_t>(any_byte(gen));
+
+            // Scan the code at an unaligned address.
+            const bytes_view view{c.data() + 1, size};
+            const auto [expected_jumpdests, expected_push_data] =
+                analyze_jumpdests_reference(view);
+            bytes jumpdest_map(expected_jumpdests.size(), 0xcc);
+            bytes push_data_map(expected_push_data.size(), 0xcc);
+            zvmc_analyze_jumpdests(view.data(), view.size(), jumpdest_map.data(),
+                                   push_data_map.data());
+            EXPECT_EQ(jumpdest_map, expected_jumpdests) << size;
+            EXPECT_EQ(push_data_map, expected_push_data) << size;
+
+            // The PUSH data map is optional.
+            bytes jumpdest_map_only(expected_jumpdests.size(), 0);
+            zvmc_analyze_jumpdests(view.data(), view.size(), jumpdest_map_only.data(), nullptr);
+            EXPECT_EQ(jumpdest_map_only, expected_jumpdests) << size;
+        }
+    }
+
+    const bytes_view code_bytes{code.data(), code.size()};
+    const auto expected_jumpdests = analyze_jumpdests_reference(code_bytes).first;
+    const CodeAnalysis analysis{ZVMC_SHANGHAI, code_bytes};
+    EXPECT_EQ(bytes(analysis.get_raw_pointer()->jumpdest_map, expected_jumpdests.size()),
+              expected_jumpdests);
+}
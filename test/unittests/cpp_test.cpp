@@ -374,6 +374,32 @@ TEST(cpp, literals)
     EXPECT_EQ(h1, f1);
 }
 
+TEST(cpp, hex_literal)
+{
+    using namespace zvmc::literals;
+
+    constexpr auto code = 0x6001600201_hex;
+    static_assert(code.size() == 5);
+    static_assert(code[0] == 0x60);
+    static_assert(code[3] == 0x02);
+    static_assert(code[4] == 0x01);
+
+    // The leading zeros are kept.
+    static_assert((0x00_hex).size() == 1);
+    static_assert((0x000000_hex).size() == 3);
+    static_assert(0x0001_hex[1] == 0x01);
+
+    // The 0x prefix is optional for decimal digits.
+    static_assert((6000_hex).size() == 2);
+    static_assert(6000_hex[0] == 0x60);
+
+    static_assert(0xAbCd_hex[0] == 0xab);
+    static_assert(0xAbCd_hex[1] == 0xcd);
+
+    const auto bytecode = 0x60aa60bb01_hex;
+    EXPECT_EQ(zvmc::bytes(bytecode.data(), bytecode.size()), *zvmc::from_hex("60aa60bb01"));
+}
+
 TEST(cpp, bytes32_from_uint)
 {
     using zvmc::bytes32;
@@ -8,6 +8,9 @@
 #include <zvmc/zvmc.hpp>
 #include <gtest/gtest.h>
 #include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
 
 using namespace zvmc::literals;
 
@@ -28,6 +31,21 @@ struct Output
 
 auto vm = zvmc::VM{zvmc_create_example_vm()};
 
+/// Counts down from 3 in a loop and returns 0x2a.
+/// It has all the instruction sequences fused by the "fusion" option.
+constexpr auto loop_code =
+    "6003"         // PUSH1 3
+    "5b"           // JUMPDEST
+    "63ffffffff"   // PUSH4 0xffffffff
+    "01"           // ADD
+    "8090"         // DUP1 SWAP1
+    "15601257"     // ISZERO PUSH1 18 JUMPI
+    "600256"       // PUSH1 2 JUMP
+    "5b"           // JUMPDEST
+    "602a01"       // PUSH1 0x2a ADD
+    "600052"       // PUSH1 0 MSTORE
+    "60206000f3";  // PUSH1 32 PUSH1 0 RETURN
+
 class example_vm : public testing::Test
 {
 protected:
@@ -41,9 +59,10 @@ protected:
         msg.recipient = "Zd00000000000000000000000000000000000000d"_address;
     }
 
-    zvmc::Result execute_in_example_vm(int64_t gas,
-                                       const char* code_hex,
-                                       const char* input_hex = "")
+    zvmc::Result execute_in(zvmc::VM& target,
+                            int64_t gas,
+                            const char* code_hex,
+                            const char* input_hex = "")
     {
         const auto code = zvmc::from_hex(code_hex).value();
         const auto input = zvmc::from_hex(input_hex).value();
@@ -52,7 +71,14 @@ protected:
         msg.input_data = input.data();
         msg.input_size = input.size();
 
-        return vm.execute(host, rev, msg, code.data(), code.size());
+        return target.execute(host, rev, msg, code.data(), code.size());
+    }
+
+    zvmc::Result execute_in_example_vm(int64_t gas,
+                                       const char* code_hex,
+                                       const char* input_hex = "")
+    {
+        return execute_in(vm, gas, code_hex, input_hex);
     }
 };
 
@@ -78,6 +104,23 @@ TEST_F(example_vm, push)
     EXPECT_EQ(r, Output("d0d1d2d3d4d5d6d7d8d9dadbdcdddedfe0e1e2e3e4e5e6e7e8e9eaebecedeeef"));
 }
 
+TEST_F(example_vm, push_sizes)
+{
+    // Yul: mstore(0, add(0xaa, add(0xbbcc, 0xddeeff00))) return(0, 32)
+    const auto r = execute_in_example_vm(10, "60aa61bbcc63ddeeff00010160005260206000f3");
+    EXPECT_EQ(r.status_code, ZVMC_SUCCESS);
+    EXPECT_EQ(r.gas_left, 0);
+    EXPECT_EQ(r, Output("00000000000000000000000000000000000000000000000000000000ddefbb76"));
+}
+
+TEST_F(example_vm, push_truncated)
+{
+    // The PUSH2 with a single byte of data at the end of the code.
+    const auto r = execute_in_example_vm(10, "61aa");
+    EXPECT_EQ(r.status_code, ZVMC_SUCCESS);
+    EXPECT_EQ(r.gas_left, 9);
+}
+
 TEST_F(example_vm, return_address)
 {
     // Yul: mstore(0, address()) return(12, 20)
@@ -195,3 +238,255 @@ TEST_F(example_vm, mstore_out_of_memory)
     EXPECT_EQ(r.gas_left, 0);
     EXPECT_EQ(r, Output(""));
 }
+
+TEST_F(example_vm, jump_loop)
+{
+    const auto r = execute_in_example_vm(100, loop_code);
+    EXPECT_EQ(r.status_code, ZVMC_SUCCESS);
+    EXPECT_EQ(r.gas_left, 100 - 37);
+    EXPECT_EQ(r, Output("000000000000000000000000000000000000000000000000000000000000002a"));
+}
+
+TEST_F(example_vm, bad_jump)
+{
+    // Yul: jump(4)
+    EXPECT_EQ(execute_in_example_vm(10, "600456").status_code, ZVMC_BAD_JUMP_DESTINATION);
+    // The jump into the PUSH data.
+    EXPECT_EQ(execute_in_example_vm(10, "600456605b").status_code, ZVMC_BAD_JUMP_DESTINATION);
+    // The jump destination above 32 bits.
+    EXPECT_EQ(execute_in_example_vm(10, "6401000000055b56").status_code,
+              ZVMC_BAD_JUMP_DESTINATION);
+    // Yul: jumpi(3, 1)
+    EXPECT_EQ(execute_in_example_vm(10, "6001600357").status_code, ZVMC_BAD_JUMP_DESTINATION);
+    // Yul: jumpi(3, 0) stop()
+    EXPECT_EQ(execute_in_example_vm(10, "600060035700").status_code, ZVMC_SUCCESS);
+}
+
+TEST_F(example_vm, stack_underflow)
+{
+    // ADD
+    EXPECT_EQ(execute_in_example_vm(10, "01").status_code, ZVMC_STACK_UNDERFLOW);
+    // The underflow at the jump destination: PUSH1 4 JUMP STOP JUMPDEST ADD
+    EXPECT_EQ(execute_in_example_vm(10, "600456005b01").status_code, ZVMC_STACK_UNDERFLOW);
+    // The gas is checked before the stack height: PUSH1 0 MSTORE
+    EXPECT_EQ(execute_in_example_vm(1, "600052").status_code, ZVMC_OUT_OF_GAS);
+
+    // The superinstructions are not executed in the failing blocks: PUSH1 1 ADD
+    auto fused_vm = zvmc::VM{zvmc_create_example_vm(), {{"fusion", "1"}}};
+    EXPECT_EQ(execute_in(fused_vm, 10, "600101").status_code, ZVMC_STACK_UNDERFLOW);
+    EXPECT_EQ(execute_in(fused_vm, 10, "5b60010100").status_code, ZVMC_STACK_UNDERFLOW);
+}
+
+TEST_F(example_vm, stack_overflow)
+{
+    std::string addresses;
+    for (int i = 0; i < 1024; ++i)
+        addresses += "30";
+    EXPECT_EQ(execute_in_example_vm(2000, addresses.c_str()).status_code, ZVMC_SUCCESS);
+    EXPECT_EQ(execute_in_example_vm(2000, (addresses + "30").c_str()).status_code,
+              ZVMC_STACK_OVERFLOW);
+    // The overflow at the jump destination: PUSH1 4 JUMP STOP JUMPDEST ADDRESS...
+    EXPECT_EQ(execute_in_example_vm(2000, ("600456005b" + addresses + "30").c_str()).status_code,
+              ZVMC_STACK_OVERFLOW);
+}
+
+TEST_F(example_vm, fusion_option)
+{
+    EXPECT_EQ(vm.set_option("fusion", "1"), ZVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(vm.set_option("fusion", "0"), ZVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(vm.set_option("fusion", "2"), ZVMC_SET_OPTION_INVALID_VALUE);
+    EXPECT_EQ(vm.set_option("fusion", nullptr), ZVMC_SET_OPTION_INVALID_VALUE);
+}
+
+TEST_F(example_vm, fusion)
+{
+    auto fused_vm = zvmc::VM{zvmc_create_example_vm(), {{"fusion", "1"}, {"verbose", "1"}}};
+
+    testing::internal::CaptureStdout();
+    const auto r = execute_in(fused_vm, 100, loop_code);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(),
+              "execution started\n\n"
+              "fused instructions: PUSH+JUMP 1 PUSH+JUMPI 0 ISZERO+PUSH+JUMPI 1 PUSH+ADD 2 "
+              "DUP1+SWAP1 1\n");
+    EXPECT_EQ(r.status_code, ZVMC_SUCCESS);
+    EXPECT_EQ(r.gas_left, 100 - 37);
+    EXPECT_EQ(r, Output("000000000000000000000000000000000000000000000000000000000000002a"));
+
+    // The decoded code is reused.
+    testing::internal::CaptureStdout();
+    execute_in(fused_vm, 100, loop_code);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "execution started\n\n");
+}
+
+TEST_F(example_vm, decoded_code_cache)
+{
+    auto fused_vm = zvmc::VM{zvmc_create_example_vm(), {{"fusion", "1"}, {"verbose", "1"}}};
+
+    // The codes differ in the pushed value, the decoding of every code is reported once.
+    const auto make_code = [](int i) {
+        return "60" + zvmc::hex(static_cast<uint8_t>(i)) + "600052596000f3";
+    };
+    const auto count_decodings = [&](int first, int last) {
+        testing::internal::CaptureStdout();
+        for (int i = first; i < last; ++i)
+        {
+            const auto code = make_code(i);
+            EXPECT_EQ(execute_in(fused_vm, 100, code.c_str()).status_code, ZVMC_SUCCESS);
+        }
+        const auto out = testing::internal::GetCapturedStdout();
+        int count = 0;
+        for (auto pos = out.find("fused"); pos != std::string::npos; pos = out.find("fused", pos))
+        {
+            ++count;
+            ++pos;
+        }
+        return count;
+    };
+
+    // The alternating codes are decoded once.
+    EXPECT_EQ(count_decodings(0, 2), 2);
+    EXPECT_EQ(count_decodings(0, 2), 0);
+    EXPECT_EQ(count_decodings(0, 2), 0);
+
+    // The cache is bounded: the least recently used codes are evicted.
+    EXPECT_EQ(count_decodings(2, 16), 14);
+    EXPECT_EQ(count_decodings(0, 16), 0);
+    EXPECT_EQ(count_decodings(16, 17), 1);
+    EXPECT_EQ(count_decodings(1, 16), 0);
+    EXPECT_EQ(count_decodings(0, 1), 1);
+}
+
+TEST_F(example_vm, fusion_equivalence)
+{
+    auto fused_vm = zvmc::VM{zvmc_create_example_vm(), {{"fusion", "1"}}};
+
+    const char* codes[] = {
+        loop_code,
+        "600456",                                // PUSH1 4 JUMP
+        "600456605b",                            // PUSH1 4 JUMP, the destination in the PUSH data
+        "6001600357",                            // PUSH1 1 PUSH1 3 JUMPI
+        "60016005575b6001600701600052596000f3",  // PUSH1 1 PUSH1 5 JUMPI
+        "600015600757005b602a60005260206000f3",  // PUSH1 0 ISZERO PUSH1 7 JUMPI
+        "600115600757005b602a60005260206000f3",  // PUSH1 1 ISZERO PUSH1 7 JUMPI
+        "60aa8090600052596000f3",                // DUP1 SWAP1
+        "60016401000000020160005260206000f3",    // PUSH5 0x0100000002 ADD
+        "600015",                                // PUSH1 0 ISZERO at the end of the code
+        "6001600115",                            // PUSH1 1 PUSH1 1 ISZERO at the end of the code
+        "600162000456",                          // PUSH3 truncated, the JUMP is its data
+        "6001640000000557",                      // PUSH5 truncated, the JUMPI is its data
+        "600115610557",                          // ISZERO PUSH2 truncated, the JUMPI is its data
+    };
+    ASSERT_EQ(execute_in_example_vm(100, codes[4]),
+              Output("0000000000000000000000000000000000000000000000000000000000000008"));
+    ASSERT_EQ(execute_in_example_vm(100, codes[5]),
+              Output("000000000000000000000000000000000000000000000000000000000000002a"));
+    ASSERT_EQ(execute_in_example_vm(100, codes[8]),
+              Output("0000000000000000000000000000000000000000000000000000000000000003"));
+
+    for (const auto code : codes)
+    {
+        for (int64_t gas = 0; gas <= 40; ++gas)
+        {
+            const auto expected = execute_in_example_vm(gas, code);
+            const auto r = execute_in(fused_vm, gas, code);
+            EXPECT_EQ(r.status_code, expected.status_code) << code << " " << gas;
+            EXPECT_EQ(r.gas_left, expected.gas_left) << code << " " << gas;
+            EXPECT_EQ(zvmc::bytes(r.output_data, r.output_size),
+                      zvmc::bytes(expected.output_data, expected.output_size))
+                << code << " " << gas;
+        }
+    }
+}
+
+TEST_F(example_vm, profile_option)
+{
+    auto profiled_vm = zvmc::VM{zvmc_create_example_vm()};
+    EXPECT_EQ(profiled_vm.set_option("profile", "1"), ZVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(profiled_vm.set_option("profile", "0"), ZVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(profiled_vm.set_option("profile", "2"), ZVMC_SET_OPTION_INVALID_VALUE);
+    EXPECT_EQ(profiled_vm.set_option("profile", nullptr), ZVMC_SET_OPTION_INVALID_VALUE);
+
+    // The empty profile.
+    testing::internal::CaptureStdout();
+    EXPECT_EQ(profiled_vm.set_option("profile", "report"), ZVMC_SET_OPTION_SUCCESS);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(),
+              "instruction               count           cycles\n"
+              "pc                        count      instruction               code\n");
+}
+
+TEST_F(example_vm, profile)
+{
+    auto profiled_vm = zvmc::VM{zvmc_create_example_vm(), {{"profile", "1"}}};
+    for (int i = 0; i < 2; ++i)
+        ASSERT_EQ(execute_in(profiled_vm, 100, loop_code).gas_left, 100 - 37);
+
+    testing::internal::CaptureStdout();
+    profiled_vm.set_option("profile", "report");
+    std::istringstream report{testing::internal::GetCapturedStdout()};
+
+    // The instruction counts, in any order as the cycles vary.
+    std::map<std::string, uint64_t> counts;
+    std::string line;
+    std::getline(report, line);
+    while (std::getline(report, line) && line.compare(0, 2, "pc") != 0)
+    {
+        std::istringstream fields{line};
+        std::string name;
+        uint64_t count = 0;
+        fields >> name >> count;
+        counts[name] = count;
+    }
+    const std::map<std::string, uint64_t> expected_counts{
+        {"PUSH1", 2 * 10},   {"PUSH4", 2 * 3},   {"ADD", 2 * 4},     {"DUP1", 2 * 3},
+        {"SWAP1", 2 * 3},    {"ISZERO", 2 * 3},  {"JUMPI", 2 * 3},   {"JUMP", 2 * 2},
+        {"JUMPDEST", 2 * 4}, {"MSTORE", 2 * 1},  {"RETURN", 2 * 1},
+    };
+    EXPECT_EQ(counts, expected_counts);
+
+    // The loop JUMPDEST is one of the hottest code positions.
+    std::getline(report, line);
+    EXPECT_EQ(line.find("2                             6         JUMPDEST   "), 0u) << line;
+
+    // The report restarts the profiling.
+    testing::internal::CaptureStdout();
+    profiled_vm.set_option("profile", "report");
+    EXPECT_EQ(testing::internal::GetCapturedStdout(),
+              "instruction               count           cycles\n"
+              "pc                        count      instruction               code\n");
+}
+
+TEST_F(example_vm, profile_multiple_codes)
+{
+    auto profiled_vm = zvmc::VM{zvmc_create_example_vm(), {{"profile", "1"}}};
+
+    // The alternating codes. The many other codes evict the loop from the decoded code cache,
+    // the counts of its later executions are still merged.
+    constexpr auto other_code = "6001600201";  // PUSH1 1 PUSH1 2 ADD
+    for (int i = 0; i < 3; ++i)
+    {
+        ASSERT_EQ(execute_in(profiled_vm, 100, loop_code).gas_left, 100 - 37);
+        ASSERT_EQ(execute_in(profiled_vm, 100, other_code).status_code, ZVMC_SUCCESS);
+        for (int j = 0; j < 20; ++j)
+        {
+            const auto code = "60" + zvmc::hex(static_cast<uint8_t>(j)) + "00";
+            ASSERT_EQ(execute_in(profiled_vm, 100, code.c_str()).status_code, ZVMC_SUCCESS);
+        }
+    }
+
+    testing::internal::CaptureStdout();
+    profiled_vm.set_option("profile", "report");
+    std::istringstream report{testing::internal::GetCapturedStdout()};
+    std::string line;
+    while (std::getline(report, line) && line.compare(0, 2, "pc") != 0)
+        ;
+
+    // The 10 hottest positions are the loop ones, executed 2 or 3 times in each of 3 executions.
+    std::getline(report, line);
+    EXPECT_EQ(line.find("2                             9         JUMPDEST   "), 0u) << line;
+    const auto loop_hash = line.substr(line.size() - 16);
+    for (int i = 0; i < 9; ++i)
+    {
+        ASSERT_TRUE(std::getline(report, line));
+        EXPECT_EQ(line.substr(line.size() - 16), loop_hash) << line;
+    }
+}
@@ -5,6 +5,7 @@
 #include <zvmc/filter_iterator.hpp>
 #include <gtest/gtest.h>
 #include <cctype>
+#include <initializer_list>
 
 using zvmc::skip_space_iterator;
 
@@ -19,6 +20,14 @@ std::string remove_space(std::string_view in)
     std::string out;
     std::copy(skip_space_iterator{in_buffer.begin(), in_buffer.end()},
               skip_space_iterator{in_buffer.end(), in_buffer.end()}, std::back_inserter(out));
+
+    // Filter the input with the contiguous range specialization.
+    const auto begin = in_buffer.data();
+    const auto end = begin + in_buffer.size();
+    std::string out_contiguous;
+    std::copy(skip_space_iterator{begin, end}, skip_space_iterator{end, end},
+              std::back_inserter(out_contiguous));
+    EXPECT_EQ(out_contiguous, out);
     return out;
 }
 
@@ -105,3 +114,62 @@ TEST(skip_space_iterator, isspace)
         }
     }
 }
+
+TEST(skip_space_iterator, find_space)
+{
+    // All characters at all positions of the blocks of different sizes (SIMD blocks and tail).
+    for (int i = int{std::numeric_limits<char>::min()}; i <= std::numeric_limits<char>::max(); ++i)
+    {
+        const auto c = static_cast<char>(i);
+        for (const auto size : std::initializer_list<size_t>{1, 15, 16, 17, 31, 32, 33, 70})
+        {
+            for (size_t pos = 0; pos < size; ++pos)
+            {
+                // Copy to the exact size buffer to detect out-of-buffer reads by sanitizers.
+                std::vector<char> spaces(size, ' ');
+                spaces[pos] = c;
+                std::vector<char> letters(size, 'a');
+                letters[pos] = c;
+                const auto s_end = spaces.data() + size;
+                const auto l_end = letters.data() + size;
+
+                const auto expected_not_space = zvmc::isspace(c) ? s_end : &spaces[pos];
+                EXPECT_EQ(zvmc::find_not_space(spaces.data(), s_end), expected_not_space);
+                const auto expected_space = zvmc::isspace(c) ? &letters[pos] : l_end;
+                EXPECT_EQ(zvmc::find_space(letters.data(), l_end), expected_space);
+            }
+        }
+    }
+    EXPECT_EQ(zvmc::find_space(nullptr, nullptr), nullptr);
+    EXPECT_EQ(zvmc::find_not_space(nullptr, nullptr), nullptr);
+}
+
+TEST(skip_space_iterator, long_runs)
+{
+    std::string in;
+    std::string expected;
+    for (size_t i = 0; i < 300; ++i)
+    {
+        in.append(i % 37, (i % 2 == 0) ? ' ' : '\n');
+        in.append(i % 23, 'x');
+        expected.append(i % 23, 'x');
+    }
+    EXPECT_EQ(remove_space(in), expected);
+}
+
+TEST(skip_space_iterator, constexpr_contiguous)
+{
+    constexpr auto count_non_space = [](std::string_view in) {
+        size_t count = 0;
+        const auto end = in.data() + in.size();
+        for (auto it = skip_space_iterator{in.data(), end}; it != skip_space_iterator{end, end};
+             ++it)
+            count += (*it != ' ');
+        return count;
+    };
+    static_assert(count_non_space(" a b\t\n c    d                                 e ") == 5);
+    constexpr std::string_view words = "abc                                     def";
+    static_assert(zvmc::find_space(words.data(), words.data() + words.size()) == &words[3]);
+    static_assert(zvmc::find_not_space(&words[3], words.data() + words.size()) == &words[40]);
+    EXPECT_EQ(count_non_space(" a b\t\n c    d                                 e "), 5);
+}
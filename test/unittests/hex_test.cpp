@@ -4,6 +4,9 @@
 
 #include <zvmc/hex.hpp>
 #include <gtest/gtest.h>
+#include <cctype>
+#include <initializer_list>
+#include <sstream>
 
 using namespace zvmc;
 
@@ -159,3 +162,179 @@ TEST(hex, from_prefixed_hex_to_custom_type)
     // The result type is too small for the input.
     EXPECT_FALSE(zvmc::from_prefixed_hex<X>("Z0000000000", "Z"));
 }
+
+TEST(hex, hex_to_buffer)
+{
+    bytes data;
+    for (int i = 0; i < 300; ++i)
+        data.push_back(static_cast<uint8_t>(i * 7 + 3));
+
+    // Compare with byte-by-byte encoding for all lengths covering the SIMD blocks and the tail.
+    for (size_t size = 0; size <= data.size(); ++size)
+    {
+        std::string expected;
+        for (size_t i = 0; i < size; ++i)
+            expected += hex(data[i]);
+
+        std::string buffer(2 * size + 1, '#');
+        const auto end = hex({data.data(), size}, buffer.data());
+        EXPECT_EQ(end, buffer.data() + 2 * size);
+        EXPECT_EQ(buffer.back(), '#');  // No write past the end.
+        buffer.pop_back();
+        EXPECT_EQ(buffer, expected);
+        EXPECT_EQ(hex({data.data(), size}), expected);
+    }
+}
+
+TEST(hex, from_hex_to_buffer)
+{
+    uint8_t buffer[4]{};
+    EXPECT_EQ(from_hex("", buffer), 0u);
+    EXPECT_EQ(from_hex("0x", buffer), 0u);
+    EXPECT_EQ(from_hex("0x0102", buffer), 2u);
+    EXPECT_EQ(buffer[0], 0x01);
+    EXPECT_EQ(buffer[1], 0x02);
+    EXPECT_EQ(from_hex("aAbBcCdD", buffer), 4u);
+    EXPECT_EQ(buffer[0], 0xaa);
+    EXPECT_EQ(buffer[3], 0xdd);
+    EXPECT_EQ(from_hex("0x0", buffer), std::nullopt);
+    EXPECT_EQ(from_hex("0x0x", buffer), std::nullopt);
+    EXPECT_EQ(from_hex("x0", buffer), std::nullopt);
+}
+
+TEST(hex, from_hex_bulk)
+{
+    bytes data;
+    for (int i = 0; i < 300; ++i)
+        data.push_back(static_cast<uint8_t>(i * 13 + 5));
+    const auto encoded = hex(data);
+
+    for (size_t size = 0; size <= data.size(); ++size)
+    {
+        const auto in = encoded.substr(0, 2 * size);
+        EXPECT_EQ(from_hex(in), data.substr(0, size));
+        EXPECT_EQ(from_hex("0x" + in), data.substr(0, size));
+
+        auto upper = in;
+        for (auto& c : upper)
+            c = static_cast<char>(std::toupper(c));
+        EXPECT_EQ(from_hex(upper), data.substr(0, size));
+    }
+}
+
+TEST(hex, from_hex_bulk_invalid_digit)
+{
+    // Characters adjacent to the valid digit ranges and outside of ASCII.
+    const char invalid[] = {'/', ':', '@', 'G', '`', 'g', 'x', ' ', '\0', '\x80', '\xb0', '\xe1'};
+    const std::string valid(160, 'a');
+    for (const auto c : invalid)
+    {
+        for (size_t pos = 0; pos < valid.size(); ++pos)
+        {
+            auto in = valid;
+            in[pos] = c;
+            EXPECT_EQ(from_hex(in), std::nullopt) << "position " << pos << " char " << int{c};
+        }
+    }
+}
+
+TEST(hex, from_spaced_hex_bulk)
+{
+    EXPECT_EQ(from_spaced_hex(""), bytes{});
+    EXPECT_EQ(from_spaced_hex(" \n"), bytes{});
+    EXPECT_EQ(from_spaced_hex("0x"), bytes{});
+    EXPECT_EQ(from_spaced_hex("0 x"), bytes{});
+    EXPECT_EQ(from_spaced_hex("0"), std::nullopt);
+    EXPECT_EQ(from_spaced_hex("0x0"), std::nullopt);
+    EXPECT_EQ(from_spaced_hex("0 0x"), std::nullopt);
+    EXPECT_EQ(from_spaced_hex("1x"), std::nullopt);
+    EXPECT_EQ(from_spaced_hex("01 2 345"), (bytes{0x01, 0x23, 0x45}));
+
+    bytes data;
+    for (int i = 0; i < 200; ++i)
+        data.push_back(static_cast<uint8_t>(i * 31 + 7));
+    const auto encoded = hex(data);
+
+    // Whitespace at various positions splits the input into runs of different parity.
+    for (size_t pos = 0; pos <= encoded.size(); ++pos)
+    {
+        auto in = encoded;
+        in.insert(pos, " \n");
+        EXPECT_EQ(from_spaced_hex(in), data) << pos;
+        EXPECT_EQ(from_spaced_hex("0x" + in), data) << pos;
+        in[in.size() / 2] = 'z';
+        EXPECT_EQ(from_spaced_hex(in), std::nullopt) << pos;
+    }
+}
+
+TEST(hex, spaced_hex_decoder_chunks)
+{
+    const std::string in = "0x 0123 456789abcdef\n0 1 2 3 4 5 6 7 8 9 A B C D E F \t 00ff";
+    const auto expected = from_spaced_hex(in);
+    ASSERT_TRUE(expected);
+
+    // Split the input into two chunks at every position.
+    for (size_t pos = 0; pos <= in.size(); ++pos)
+    {
+        spaced_hex_decoder decoder;
+        bytes out(in.size(), 0);
+        const auto n1 = decoder.decode(std::string_view{in}.substr(0, pos), out.data());
+        ASSERT_TRUE(n1);
+        EXPECT_LE(*n1, spaced_hex_decoder::max_decoded_size(pos));
+        const auto n2 = decoder.decode(std::string_view{in}.substr(pos), &out[*n1]);
+        ASSERT_TRUE(n2);
+        EXPECT_TRUE(decoder.finish());
+        out.resize(*n1 + *n2);
+        EXPECT_EQ(out, *expected) << pos;
+    }
+
+    spaced_hex_decoder decoder;
+    uint8_t out[4]{};
+    EXPECT_EQ(decoder.decode("a", out), 0u);
+    EXPECT_FALSE(decoder.finish());
+    EXPECT_EQ(decoder.decode("b c", out), 1u);
+    EXPECT_EQ(out[0], 0xab);
+    EXPECT_FALSE(decoder.finish());
+    EXPECT_EQ(decoder.decode("g", out), std::nullopt);
+    EXPECT_FALSE(decoder.finish());
+    EXPECT_EQ(decoder.decode("0", out), std::nullopt);  // Stays invalid.
+}
+
+TEST(hex, from_spaced_hex_stream)
+{
+    std::string in;
+    bytes expected;
+    for (int i = 0; i < 1000; ++i)
+    {
+        const auto b = static_cast<uint8_t>(i * 17 + 1);
+        in += hex(b);
+        in += (i % 7 == 0) ? "\n" : (i % 3 == 0 ? " " : "");
+        expected.push_back(b);
+    }
+
+    for (const auto chunk_size : std::initializer_list<size_t>{1, 2, 3, 16, 33, 64 * 1024})
+    {
+        std::istringstream stream{in};
+        bytes out;
+        size_t num_chunks = 0;
+        const auto valid = from_spaced_hex_stream(
+            stream,
+            [&](bytes_view chunk) {
+                EXPECT_FALSE(chunk.empty());
+                out += chunk;
+                ++num_chunks;
+            },
+            chunk_size);
+        EXPECT_TRUE(valid);
+        EXPECT_EQ(out, expected);
+        if (chunk_size < in.size())
+        {
+            EXPECT_GT(num_chunks, 1u);
+        }
+    }
+
+    std::istringstream odd{"0x012"};
+    EXPECT_FALSE(from_spaced_hex_stream(odd, [](bytes_view) {}));
+    std::istringstream invalid{"0x01 02 0g"};
+    EXPECT_FALSE(from_spaced_hex_stream(invalid, [](bytes_view) {}, 4));
+}
@@ -3,6 +3,7 @@
 // Licensed under the Apache License, Version 2.0.
 
 #include <zvmc/instructions.h>
+#include <zvmc/instructions.hpp>
 #include <gtest/gtest.h>
 
 inline bool operator==(const zvmc_instruction_metrics& a,
@@ -109,3 +110,101 @@ TEST(instructions, shanghai_hard_fork)
     EXPECT_EQ(s[OP_PUSH0].stack_height_change, 1);
     EXPECT_EQ(sn[OP_PUSH0], std::string{"PUSH0"});
 }
+
+// The opcodes in the instruction list match the zvmc_opcode enum.
+#define ZVMC_INSTRUCTION(NAME, OPCODE, GAS_COST, STACK_REQUIRED, STACK_CHANGE, IMMEDIATE_SIZE, \
+                         FLAGS)                                                                \
+    static_assert(OP_##NAME == OPCODE);
+#include <zvmc/instructions.def>
+#undef ZVMC_INSTRUCTION
+
+TEST(instructions, traits_match_c_tables)
+{
+    const auto metrics = zvmc_get_instruction_metrics_table(ZVMC_SHANGHAI);
+    const auto names = zvmc_get_instruction_names_table(ZVMC_SHANGHAI);
+    const auto& traits = zvmc::instr::traits_table<ZVMC_SHANGHAI>;
+
+    for (size_t i = 0; i < 256; ++i)
+    {
+        const auto& t = traits[i];
+        EXPECT_EQ(t.gas_cost, metrics[i].gas_cost) << i;
+        EXPECT_EQ(t.stack_height_required, metrics[i].stack_height_required) << i;
+        EXPECT_EQ(t.stack_height_change, metrics[i].stack_height_change) << i;
+        ASSERT_EQ(t.is_defined(), names[i] != nullptr) << i;
+        if (t.is_defined())
+        {
+            EXPECT_STREQ(t.name, names[i]);
+        }
+
+        const auto is_push = i >= OP_PUSH1 && i <= OP_PUSH32;
+        EXPECT_EQ(t.immediate_size, is_push ? i - OP_PUSH1 + 1 : 0) << i;
+    }
+}
+
+TEST(instructions, info_table)
+{
+    EXPECT_EQ(sizeof(zvmc_instruction_info), 8u);
+    EXPECT_EQ(zvmc_get_instruction_info_table(static_cast<zvmc_revision>(ZVMC_MAX_REVISION + 1)),
+              nullptr);
+
+    const auto info = zvmc_get_instruction_info_table(ZVMC_SHANGHAI);
+    const auto& traits = zvmc::instr::traits_table<ZVMC_SHANGHAI>;
+    for (size_t i = 0; i < 256; ++i)
+    {
+        const auto& t = traits[i];
+        EXPECT_EQ(info[i].gas_cost, t.gas_cost) << i;
+        EXPECT_EQ(info[i].stack_height_required, t.stack_height_required) << i;
+        EXPECT_EQ(info[i].stack_height_change, t.stack_height_change) << i;
+        EXPECT_EQ(info[i].immediate_size, t.immediate_size) << i;
+        EXPECT_EQ((info[i].flags & ZVMC_INSTRUCTION_DEFINED) != 0, t.is_defined()) << i;
+        EXPECT_EQ(info[i].flags & ~(ZVMC_INSTRUCTION_DEFINED | ZVMC_INSTRUCTION_ENDS_BLOCK),
+                  t.flags)
+            << i;
+        const auto ends_block = (info[i].flags & ZVMC_INSTRUCTION_ENDS_BLOCK) != 0;
+        EXPECT_EQ(ends_block || !t.is_defined(), t.ends_block()) << i;
+        if (t.writes_state() || t.reads_state())
+        {
+            EXPECT_TRUE(t.accesses_host()) << i;
+        }
+    }
+
+    EXPECT_EQ(info[OP_JUMPI].flags,
+              ZVMC_INSTRUCTION_DEFINED | ZVMC_INSTRUCTION_JUMP | ZVMC_INSTRUCTION_ENDS_BLOCK);
+    EXPECT_EQ(info[OP_ADD].flags, ZVMC_INSTRUCTION_DEFINED);
+    EXPECT_EQ(info[OP_PUSH7].immediate_size, 7);
+    EXPECT_EQ(info[OP_MSTORE].flags,
+              ZVMC_INSTRUCTION_DEFINED | ZVMC_INSTRUCTION_DYNAMIC_GAS | ZVMC_INSTRUCTION_MEMORY);
+    EXPECT_EQ(info[OP_NUMBER].flags, ZVMC_INSTRUCTION_DEFINED | ZVMC_INSTRUCTION_HOST);
+    EXPECT_EQ(info[OP_RETURN].flags & ZVMC_INSTRUCTION_ENDS_BLOCK, ZVMC_INSTRUCTION_ENDS_BLOCK);
+    EXPECT_EQ(info[0xef].flags, 0);
+}
+
+TEST(instructions, traits_constexpr)
+{
+    using namespace zvmc::instr;
+
+    static_assert(traits<ZVMC_SHANGHAI, OP_ADD>.gas_cost == 3);
+    static_assert(traits<ZVMC_SHANGHAI, OP_PUSH20>.immediate_size == 20);
+    static_assert(traits<ZVMC_SHANGHAI, OP_STOP>.is_terminator());
+    static_assert(traits<ZVMC_SHANGHAI, OP_RETURN>.is_terminator());
+    static_assert(!traits<ZVMC_SHANGHAI, OP_JUMP>.is_terminator());
+    static_assert(traits<ZVMC_SHANGHAI, OP_JUMPI>.is_jump());
+    static_assert(traits<ZVMC_SHANGHAI, OP_SLOAD>.reads_state());
+    static_assert(!traits<ZVMC_SHANGHAI, OP_SLOAD>.writes_state());
+    static_assert(traits<ZVMC_SHANGHAI, OP_SSTORE>.writes_state());
+    static_assert(traits<ZVMC_SHANGHAI, OP_LOG2>.writes_state());
+    static_assert(!traits<ZVMC_SHANGHAI, OP_STATICCALL>.writes_state());
+    static_assert(!traits<ZVMC_SHANGHAI, 0x0c>.is_defined());
+    static_assert(traits<ZVMC_SHANGHAI, 0x0c>.ends_block());
+    static_assert(traits<ZVMC_SHANGHAI, OP_JUMP>.ends_block());
+    static_assert(!traits<ZVMC_SHANGHAI, OP_JUMPDEST>.ends_block());
+    static_assert(traits<ZVMC_SHANGHAI, OP_EXP>.has_dynamic_gas());
+    static_assert(!traits<ZVMC_SHANGHAI, OP_EXP>.accesses_memory());
+    static_assert(traits<ZVMC_SHANGHAI, OP_MSIZE>.accesses_memory());
+    static_assert(traits<ZVMC_SHANGHAI, OP_TIMESTAMP>.accesses_host());
+    static_assert(!traits<ZVMC_SHANGHAI, OP_CALLER>.accesses_host());
+
+    // The traits can be used as template arguments.
+    std::array<int, traits<ZVMC_SHANGHAI, OP_LOG3>.stack_height_required> log3_args{};
+    EXPECT_EQ(log3_args.size(), 5u);
+}
@@ -12,24 +12,49 @@ static const int magic_handle = 0xE7AC;
 const char* zvmc_test_library_path = NULL;
 const char* zvmc_test_library_symbol = NULL;
 zvmc_create_fn zvmc_test_create_fn = NULL;
+int zvmc_test_library_flags = -1;
+int zvmc_test_prefault_count = 0;
+int zvmc_test_close_count = 0;
+void (*zvmc_test_library_constructor)(void) = NULL;
+void (*zvmc_test_library_destructor)(void) = NULL;
 
 static const char* zvmc_test_last_error_msg = NULL;
 
 /* Limited variant of strcpy_s(). Exposed to unittests when building with ZVMC_LOADER_MOCK. */
 int strcpy_sx(char* dest, size_t destsz, const char* src);
 
-static int zvmc_test_load_library(const char* filename)
+/* Unloads all modules from the loader registry. Exposed to unittests with ZVMC_LOADER_MOCK. */
+void zvmc_test_reset_registry(void);
+
+static int zvmc_test_load_library(const char* filename, int flags)
 {
     zvmc_test_last_error_msg = NULL;
+    zvmc_test_library_flags = flags;
     if (filename && zvmc_test_library_path && strcmp(filename, zvmc_test_library_path) == 0)
+    {
+        // Run the "module constructor" once, it may call the loader recursively.
+        void (*constructor)(void) = zvmc_test_library_constructor;
+        zvmc_test_library_constructor = NULL;
+        if (constructor)
+            constructor();
         return magic_handle;
+    }
     zvmc_test_last_error_msg = "cannot load library";
     return 0;
 }
 
 static void zvmc_test_free_library(int handle)
 {
-    (void)handle;
+    if (handle == magic_handle)
+    {
+        ++zvmc_test_close_count;
+
+        // Run the "module destructor" once, it may call the loader recursively.
+        void (*destructor)(void) = zvmc_test_library_destructor;
+        zvmc_test_library_destructor = NULL;
+        if (destructor)
+            destructor();
+    }
 }
 
 static zvmc_create_fn zvmc_test_get_symbol_address(int handle, const char* symbol)
@@ -42,6 +67,12 @@ static zvmc_create_fn zvmc_test_get_symbol_address(int handle, const char* symbo
     return NULL;
 }
 
+static void zvmc_test_prefault_library(int handle)
+{
+    if (handle == magic_handle)
+        ++zvmc_test_prefault_count;
+}
+
 static const char* zvmc_test_get_last_error_msg(void)
 {
     // Return the last error message only once.
@@ -51,7 +82,8 @@ static const char* zvmc_test_get_last_error_msg(void)
 }
 
 #define DLL_HANDLE int
-#define DLL_OPEN(filename) zvmc_test_load_library(filename)
+#define DLL_OPEN(filename, flags) zvmc_test_load_library(filename, flags)
 #define DLL_CLOSE(handle) zvmc_test_free_library(handle)
 #define DLL_GET_CREATE_FN(handle, name) zvmc_test_get_symbol_address(handle, name)
 #define DLL_GET_ERROR_MSG() zvmc_test_get_last_error_msg()
+#define DLL_PREFAULT(handle, create_fn) zvmc_test_prefault_library(handle)
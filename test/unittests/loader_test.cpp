@@ -4,9 +4,14 @@
 
 #include <zvmc/helpers.h>
 #include <zvmc/loader.h>
+#include <zvmc/loader.hpp>
 #include <zvmc/zvmc.h>
 #include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -28,6 +33,24 @@ extern const char* zvmc_test_library_symbol;
 
 /// The pointer to function returned by zvmc_test_get_symbol_address().
 extern zvmc_create_fn zvmc_test_create_fn;
+
+/// The flags passed to the last mocked zvmc_test_load_library().
+extern int zvmc_test_library_flags;
+
+/// The number of mocked module prefaults.
+extern int zvmc_test_prefault_count;
+
+/// The number of mocked module closes.
+extern int zvmc_test_close_count;
+
+/// The function called once by the next mocked zvmc_test_load_library() as the module constructor.
+extern void (*zvmc_test_library_constructor)();
+
+/// The function called once by the next mocked close of the library as the module destructor.
+extern void (*zvmc_test_library_destructor)();
+
+/// Unloads all modules from the loader registry. Defined in loader.c.
+void zvmc_test_reset_registry();
 }
 
 class loader : public ::testing::Test
@@ -52,6 +75,10 @@ protected:
         zvmc_test_library_path = path;
         zvmc_test_library_symbol = symbol;
         zvmc_test_create_fn = fn;
+
+        // The mocked library changes, so the modules cached by the loader are invalid.
+        zvmc_test_library_destructor = nullptr;
+        zvmc_test_reset_registry();
     }
 
     static void destroy(zvmc_vm* /*vm*/) noexcept { ++destroy_count; }
@@ -665,3 +692,639 @@ TEST_F(loader, load_and_configure_unknown_set_option_error_code)
                   option_name_causing_unknown_error + "'");
     EXPECT_EQ(destroy_count, create_count);
 }
+
+TEST_F(loader, load_cached)
+{
+    setup("path", "zvmc_create", create_aaa);
+
+    zvmc_loader_error_code ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
+    EXPECT_EQ(zvmc_load("path", &ec), &create_aaa);
+    EXPECT_EQ(ec, ZVMC_LOADER_SUCCESS);
+
+    // The library is not opened again, so the change of the create function is not visible.
+    zvmc_test_create_fn = create_eee_bbb;
+    EXPECT_EQ(zvmc_load("path", &ec), &create_aaa);
+    EXPECT_EQ(ec, ZVMC_LOADER_SUCCESS);
+    EXPECT_TRUE(zvmc_last_error_msg() == nullptr);
+
+    EXPECT_EQ(zvmc_release("path", 1), 1);
+    EXPECT_EQ(zvmc_load("path", nullptr), &create_aaa);
+    EXPECT_EQ(zvmc_release("path", 1), 1);
+    EXPECT_EQ(zvmc_release("path", 1), 0);
+
+    // The module has been unloaded.
+    EXPECT_EQ(zvmc_release("path", 1), -1);
+    EXPECT_EQ(zvmc_load("path", nullptr), &create_eee_bbb);
+}
+
+TEST_F(loader, release_without_unload)
+{
+    setup("path", "zvmc_create", create_aaa);
+
+    EXPECT_EQ(zvmc_load("path", nullptr), &create_aaa);
+    EXPECT_EQ(zvmc_release("path", 0), 0);
+    EXPECT_EQ(zvmc_release("path", 0), 0);
+
+    // The module is kept loaded.
+    zvmc_test_create_fn = create_eee_bbb;
+    EXPECT_EQ(zvmc_load("path", nullptr), &create_aaa);
+    EXPECT_EQ(zvmc_release("path", 0), 0);
+    EXPECT_EQ(zvmc_release("path", 1), 0);
+    EXPECT_EQ(zvmc_release("path", 1), -1);
+}
+
+TEST_F(loader, release_not_loaded)
+{
+    setup("path", "zvmc_create", create_aaa);
+
+    EXPECT_EQ(zvmc_release("path", 0), -1);
+    EXPECT_EQ(zvmc_release(nullptr, 0), -1);
+    EXPECT_EQ(zvmc_release(std::string(5000, 'a').c_str(), 0), -1);
+
+    // Failed loads are not cached.
+    EXPECT_TRUE(zvmc_load("other", nullptr) == nullptr);
+    EXPECT_EQ(zvmc_release("other", 0), -1);
+}
+
+TEST_F(loader, load_cached_canonical_path)
+{
+    // The mocked loader only opens the exact path, but the existing file paths are canonicalized
+    // so other paths to the same file are served from the registry.
+    constexpr auto filename = "loader_test_module.zvm";
+    std::ofstream{filename}.put('\0');
+
+    setup("./loader_test_module.zvm", "zvmc_create", create_aaa);
+    EXPECT_EQ(zvmc_load("./loader_test_module.zvm", nullptr), &create_aaa);
+    EXPECT_EQ(zvmc_load("././loader_test_module.zvm", nullptr), &create_aaa);
+
+    // The bare file names are not canonicalized.
+    EXPECT_TRUE(zvmc_load(filename, nullptr) == nullptr);
+
+    EXPECT_EQ(zvmc_release("./././loader_test_module.zvm", 1), 1);
+    EXPECT_EQ(zvmc_release("./loader_test_module.zvm", 1), 0);
+    std::remove(filename);
+}
+
+TEST_F(loader, load_and_create_failure_releases_module)
+{
+    setup("failure.vm", "zvmc_create", create_failure);
+
+    EXPECT_TRUE(zvmc_load_and_create("failure.vm", nullptr) == nullptr);
+    EXPECT_EQ(zvmc_release("failure.vm", 0), 0);
+
+    setup("path", "zvmc_create", create_vm_barebone);
+    auto vm = zvmc_load_and_configure("path,o=1", nullptr);
+    EXPECT_FALSE(vm);
+    EXPECT_EQ(zvmc_release("path", 0), 0);
+
+    vm = zvmc_load_and_create("path", nullptr);
+    EXPECT_TRUE(vm);
+    zvmc_destroy(vm);
+    EXPECT_EQ(zvmc_release("path", 0), 0);
+}
+
+TEST_F(loader, load_concurrently)
+{
+    setup("path", "zvmc_create", create_aaa);
+
+    constexpr int num_threads = 8;
+    constexpr int num_loads = 100;
+    std::vector<std::thread> threads;
+    std::vector<int> num_loaded(num_threads);
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&num_loaded, t] {
+            for (int i = 0; i < num_loads; ++i)
+                num_loaded[static_cast<size_t>(t)] += zvmc_load("path", nullptr) == &create_aaa;
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (const auto n : num_loaded)
+        EXPECT_EQ(n, num_loads);
+    EXPECT_EQ(zvmc_release("path", 1), num_threads * num_loads - 1);
+}
+
+TEST_F(loader, load_from_module_constructor)
+{
+    setup("path", "zvmc_create", create_aaa);
+    zvmc_test_close_count = 0;
+
+    // The module constructor loads the same module again, as if another thread won the race
+    // of loading it. The outer load takes the registered module and closes its own handle.
+    zvmc_test_library_constructor = [] { EXPECT_EQ(zvmc_load("path", nullptr), &create_aaa); };
+    EXPECT_EQ(zvmc_load("path", nullptr), &create_aaa);
+    EXPECT_EQ(zvmc_test_close_count, 1);
+    EXPECT_EQ(zvmc_release("path", 1), 1);
+    EXPECT_EQ(zvmc_release("path", 1), 0);
+    EXPECT_EQ(zvmc_test_close_count, 2);
+}
+
+TEST_F(loader, load_and_configure_r)
+{
+    setup("path", "zvmc_create", create_vm_with_set_option);
+
+    char msg[64] = "x";
+    zvmc_loader_error_code ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
+    auto vm = zvmc_load_and_configure_r("path", &ec, msg, sizeof(msg));
+    EXPECT_TRUE(vm);
+    EXPECT_EQ(ec, ZVMC_LOADER_SUCCESS);
+    EXPECT_STREQ(msg, "");
+    zvmc_destroy(vm);
+
+    vm = zvmc_load_and_configure_r("path,o=1", &ec, msg, sizeof(msg));
+    EXPECT_FALSE(vm);
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_OPTION_NAME);
+    EXPECT_STREQ(msg, "vm_with_set_option (path): unknown option 'o'");
+    EXPECT_TRUE(zvmc_last_error_msg() == nullptr);
+
+    char small_msg[10];
+    vm = zvmc_load_and_configure_r("path,o=1", &ec, small_msg, sizeof(small_msg));
+    EXPECT_FALSE(vm);
+    EXPECT_STREQ(small_msg, "vm_with_s");
+    EXPECT_TRUE(zvmc_last_error_msg() == nullptr);
+
+    vm = zvmc_load_and_configure_r("path,o=1", &ec, nullptr, 0);
+    EXPECT_FALSE(vm);
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_OPTION_NAME);
+    EXPECT_TRUE(zvmc_last_error_msg() == nullptr);
+    EXPECT_EQ(destroy_count, create_count);
+}
+
+TEST_F(loader, error_msg_per_thread)
+{
+    setup("path", "zvmc_create", create_aaa);
+
+    EXPECT_TRUE(zvmc_load("", nullptr) == nullptr);
+
+    std::string thread_msg;
+    std::thread{[&thread_msg] {
+        // The error of the main thread is not visible here.
+        EXPECT_TRUE(zvmc_last_error_msg() == nullptr);
+        EXPECT_TRUE(zvmc_load(nullptr, nullptr) == nullptr);
+        thread_msg = zvmc_last_error_msg();
+    }}.join();
+
+    EXPECT_EQ(thread_msg, "invalid argument: file name cannot be null");
+    EXPECT_STREQ(zvmc_last_error_msg(), "invalid argument: file name cannot be empty");
+}
+
+namespace
+{
+zvmc_vm* create_vm_without_counters()
+{
+    static auto instance = zvmc_vm{
+        ZVMC_ABI_VERSION, "vm", "", [](zvmc_vm*) {}, nullptr, nullptr, nullptr};
+    return &instance;
+}
+}  // namespace
+
+TEST_F(loader, load_and_configure_r_concurrently)
+{
+    // Every thread uses different path to the same file, so the error messages differ.
+    constexpr auto filename = "loader_test_module.zvm";
+    std::ofstream{filename}.put('\0');
+    setup("./loader_test_module.zvm", "zvmc_create", create_vm_without_counters);
+    ASSERT_TRUE(zvmc_load("./loader_test_module.zvm", nullptr) != nullptr);
+
+    constexpr int num_threads = 8;
+    std::vector<std::thread> threads;
+    std::vector<std::string> msgs(num_threads);
+    for (int t = 0; t < num_threads; ++t)
+    {
+        threads.emplace_back([&msgs, t] {
+            std::string path;
+            for (int i = 0; i <= t; ++i)
+                path += "./";
+            path += "loader_test_module.zvm";
+            const auto expected_msg = "vm (" + path + ") does not support any options";
+            const auto config = path + ",o";
+
+            char msg[100]{};
+            for (int i = 0; i < 100; ++i)
+            {
+                zvmc_load_and_configure_r(config.c_str(), nullptr, msg, sizeof(msg));
+                if (msg != expected_msg)
+                    break;
+            }
+            msgs[static_cast<size_t>(t)] = msg;
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    for (int t = 0; t < num_threads; ++t)
+    {
+        std::string path;
+        for (int i = 0; i <= t; ++i)
+            path += "./";
+        EXPECT_EQ(msgs[static_cast<size_t>(t)],
+                  "vm (" + path + "loader_test_module.zvm) does not support any options");
+    }
+    std::remove(filename);
+}
+
+namespace
+{
+std::atomic<int> warmup_count;
+
+zvmc_result execute_warmup(zvmc_vm* /*vm*/,
+                           const zvmc_host_interface* host,
+                           zvmc_host_context* context,
+                           zvmc_revision rev,
+                           const zvmc_message* msg,
+                           const uint8_t* code,
+                           size_t code_size)
+{
+    // Check the Host is usable.
+    const zvmc_address addr{};
+    const auto call_result = host->call(context, msg);
+    const auto ok = rev == ZVMC_SHANGHAI && msg->gas == 100 && code_size == 2 &&
+                    code[1] == 0xfe && !host->account_exists(context, &addr) &&
+                    call_result.status_code == ZVMC_FAILURE;
+    if (ok)
+        ++warmup_count;
+    return zvmc_make_result(ZVMC_SUCCESS, 0, 0, nullptr, 0);
+}
+
+zvmc_vm* create_vm_with_execute()
+{
+    static auto instance = zvmc_vm{
+        ZVMC_ABI_VERSION, "vm", "", [](zvmc_vm*) {}, execute_warmup, nullptr, nullptr};
+    return &instance;
+}
+}  // namespace
+
+TEST_F(loader, load_many)
+{
+    setup("path", "zvmc_create", create_vm_with_execute);
+
+    const char* configs[] = {"path", "path,o", "bad", "path"};
+    zvmc_vm* vms[std::size(configs)];
+    zvmc_loader_error_code ecs[std::size(configs)];
+    EXPECT_EQ(zvmc_load_many(configs, std::size(configs), nullptr, vms, ecs), 2u);
+    EXPECT_EQ(vms[0], create_vm_with_execute());
+    EXPECT_EQ(vms[1], nullptr);
+    EXPECT_EQ(vms[2], nullptr);
+    EXPECT_EQ(vms[3], create_vm_with_execute());
+    EXPECT_EQ(ecs[0], ZVMC_LOADER_SUCCESS);
+    EXPECT_EQ(ecs[1], ZVMC_LOADER_INVALID_OPTION_NAME);
+    EXPECT_EQ(ecs[2], ZVMC_LOADER_CANNOT_OPEN);
+    EXPECT_EQ(ecs[3], ZVMC_LOADER_SUCCESS);
+    EXPECT_STREQ(zvmc_last_error_msg(), "vm (path) does not support any options");
+    EXPECT_TRUE(zvmc_last_error_msg() == nullptr);
+
+    EXPECT_EQ(zvmc_load_many(configs, 1, nullptr, vms, nullptr), 1u);
+    EXPECT_TRUE(zvmc_last_error_msg() == nullptr);
+    EXPECT_EQ(zvmc_load_many(nullptr, 0, nullptr, nullptr, nullptr), 0u);
+
+    // More configurations than worker threads.
+    const std::vector<const char*> many_configs(1000, "path");
+    std::vector<zvmc_vm*> many_vms(many_configs.size());
+    EXPECT_EQ(zvmc_load_many(many_configs.data(), many_configs.size(), nullptr, many_vms.data(),
+                             nullptr),
+              many_configs.size());
+    for (const auto vm : many_vms)
+        EXPECT_EQ(vm, create_vm_with_execute());
+}
+
+TEST_F(loader, load_many_warmup)
+{
+    setup("path", "zvmc_create", create_vm_with_execute);
+    warmup_count = 0;
+
+    const uint8_t code[] = {0x00, 0xfe};
+    const uint8_t input[] = {0x01};
+    const zvmc_warmup warmup{ZVMC_SHANGHAI, code, sizeof(code), input, sizeof(input), 100, 3};
+    const char* configs[] = {"path", "path", "path,o", "path"};
+    zvmc_vm* vms[std::size(configs)];
+    EXPECT_EQ(zvmc_load_many(configs, std::size(configs), &warmup, vms, nullptr), 3u);
+    EXPECT_EQ(warmup_count, 9);
+}
+
+TEST_F(loader, load_many_cpp)
+{
+    setup("path", "zvmc_create", create_vm_with_execute);
+
+    std::vector<zvmc_loader_error_code> ecs;
+    const auto vms = zvmc::load_many({"path", "bad"}, nullptr, &ecs);
+    ASSERT_EQ(vms.size(), 2u);
+    EXPECT_TRUE(vms[0]);
+    EXPECT_EQ(vms[0].name(), std::string{"vm"});
+    EXPECT_FALSE(vms[1]);
+    EXPECT_EQ(ecs, (std::vector{ZVMC_LOADER_SUCCESS, ZVMC_LOADER_CANNOT_OPEN}));
+    EXPECT_STREQ(zvmc_last_error_msg(), "cannot load library");
+
+    warmup_count = 0;
+    const uint8_t code[] = {0x00, 0xfe};
+    const auto warm_vms = zvmc::load_many({"path", "path"}, ZVMC_SHANGHAI, {code, 2}, 100, 2);
+    ASSERT_EQ(warm_vms.size(), 2u);
+    EXPECT_TRUE(warm_vms[0]);
+    EXPECT_TRUE(warm_vms[1]);
+    EXPECT_EQ(warmup_count, 4);
+}
+
+TEST_F(loader, load_and_configure_loader_options)
+{
+    // The values of the loader option flags in loader.c.
+    constexpr int bind_now = 1;
+    constexpr int deepbind = 2;
+    constexpr int prefault = 4;
+
+    supported_options["o"] = {"1"};
+    setup("path", "zvmc_create", create_vm_with_set_option);
+    zvmc_test_prefault_count = 0;
+
+    zvmc_loader_error_code ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
+    auto vm = zvmc_load_and_configure("path?bind=now,o=1", &ec);
+    EXPECT_TRUE(vm);
+    EXPECT_EQ(ec, ZVMC_LOADER_SUCCESS);
+    EXPECT_EQ(zvmc_test_library_flags, bind_now);
+    ASSERT_EQ(recorded_options.size(), size_t{1});
+    EXPECT_EQ(recorded_options[0].first, "o");
+    EXPECT_EQ(zvmc_test_prefault_count, 0);
+    zvmc_destroy(vm);
+
+    // The module is already loaded, the loader options are not applied again.
+    vm = zvmc_load_and_configure("path?prefault", &ec);
+    EXPECT_TRUE(vm);
+    EXPECT_EQ(zvmc_test_library_flags, bind_now);
+    EXPECT_EQ(zvmc_test_prefault_count, 0);
+    zvmc_destroy(vm);
+
+    const std::pair<const char*, int> configs[] = {
+        {"path", 0},
+        {"path?bind=lazy", 0},
+        {"path?bind=now?bind=lazy", 0},
+        {"path?deepbind", deepbind},
+        {"path?prefault?bind=now", bind_now | prefault},
+        {"path?bind=now?deepbind?prefault,", bind_now | deepbind | prefault},
+        {"path?,o=1", 0},
+    };
+    for (const auto& [config, flags] : configs)
+    {
+        setup("path", "zvmc_create", create_vm_with_set_option);
+        vm = zvmc_load_and_configure(config, &ec);
+        EXPECT_TRUE(vm) << config;
+        EXPECT_EQ(ec, ZVMC_LOADER_SUCCESS) << config;
+        EXPECT_EQ(zvmc_test_library_flags, flags) << config;
+        zvmc_destroy(vm);
+    }
+    EXPECT_EQ(zvmc_test_prefault_count, 2);
+    EXPECT_EQ(destroy_count, create_count);
+}
+
+TEST_F(loader, load_and_configure_invalid_loader_options)
+{
+    setup("path", "zvmc_create", create_vm_with_set_option);
+    zvmc_test_library_flags = -1;
+
+    zvmc_loader_error_code ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
+    EXPECT_FALSE(zvmc_load_and_configure("path?bind=never,o=1", &ec));
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_OPTION_VALUE);
+    EXPECT_STREQ(zvmc_last_error_msg(), "path: unsupported value 'never' for loader option 'bind'");
+
+    EXPECT_FALSE(zvmc_load_and_configure("path?prefault=1", &ec));
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_OPTION_VALUE);
+    EXPECT_STREQ(zvmc_last_error_msg(), "path: unsupported value '1' for loader option 'prefault'");
+
+    EXPECT_FALSE(zvmc_load_and_configure("path?bind", &ec));
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_OPTION_VALUE);
+    EXPECT_STREQ(zvmc_last_error_msg(), "path: unsupported value '' for loader option 'bind'");
+
+    EXPECT_FALSE(zvmc_load_and_configure("path?bind=now?lazy", &ec));
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_OPTION_NAME);
+    EXPECT_STREQ(zvmc_last_error_msg(), "path: unknown loader option 'lazy'");
+
+    EXPECT_FALSE(zvmc_load_and_configure("path??", nullptr));
+    EXPECT_STREQ(zvmc_last_error_msg(), "path: unknown loader option ''");
+
+    // The module is not loaded when the loader options are invalid.
+    EXPECT_EQ(zvmc_test_library_flags, -1);
+    EXPECT_EQ(create_count, 0);
+}
+
+namespace
+{
+zvmc_vm* create_static_vm()
+{
+    static auto instance = zvmc_vm{
+        ZVMC_ABI_VERSION, "static_vm", "", [](zvmc_vm*) {}, nullptr, nullptr, nullptr};
+    return &instance;
+}
+
+zvmc_vm* create_registered_at_startup()
+{
+    return create_static_vm();
+}
+}  // namespace
+
+ZVMC_REGISTER_STATIC_VM("startup_vm", create_registered_at_startup)
+
+TEST_F(loader, static_vm)
+{
+    // Nothing is going to be opened.
+    setup(nullptr, nullptr, nullptr);
+
+    EXPECT_EQ(zvmc_register_static_vm("static_vm", create_static_vm), 1);
+    EXPECT_EQ(zvmc_register_static_vm("static_vm", create_aaa), 0);
+    EXPECT_EQ(zvmc_find_static_vm("static_vm"), &create_static_vm);
+
+    zvmc_loader_error_code ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
+    EXPECT_EQ(zvmc_load("static:static_vm", &ec), &create_static_vm);
+    EXPECT_EQ(ec, ZVMC_LOADER_SUCCESS);
+
+    auto vm = zvmc_load_and_configure("static:static_vm?prefault", &ec);
+    EXPECT_EQ(vm, create_static_vm());
+    EXPECT_EQ(ec, ZVMC_LOADER_SUCCESS);
+
+    vm = zvmc_load_and_configure("static:static_vm,o=1", &ec);
+    EXPECT_FALSE(vm);
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_OPTION_NAME);
+    EXPECT_STREQ(zvmc_last_error_msg(),
+                 "static_vm (static:static_vm) does not support any options");
+}
+
+TEST_F(loader, static_vm_not_registered)
+{
+    setup(nullptr, nullptr, nullptr);
+
+    zvmc_loader_error_code ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
+    EXPECT_TRUE(zvmc_load("static:unknown", &ec) == nullptr);
+    EXPECT_EQ(ec, ZVMC_LOADER_CANNOT_OPEN);
+    EXPECT_STREQ(zvmc_last_error_msg(), "static VM 'unknown' is not registered");
+
+    EXPECT_FALSE(zvmc_load_and_create("static:", &ec));
+    EXPECT_EQ(ec, ZVMC_LOADER_CANNOT_OPEN);
+    EXPECT_STREQ(zvmc_last_error_msg(), "static VM '' is not registered");
+
+    EXPECT_TRUE(zvmc_find_static_vm("unknown") == nullptr);
+    EXPECT_TRUE(zvmc_find_static_vm(nullptr) == nullptr);
+    EXPECT_EQ(zvmc_register_static_vm("", create_aaa), 0);
+    EXPECT_EQ(zvmc_register_static_vm(nullptr, create_aaa), 0);
+    EXPECT_EQ(zvmc_register_static_vm("null", nullptr), 0);
+}
+
+TEST_F(loader, static_vm_registered_by_loaded_module)
+{
+    // The ZVMC_REGISTER_STATIC_VM() in a loaded module registers the VM from its constructor.
+    setup("path", "zvmc_create", create_aaa);
+    zvmc_test_library_constructor = [] {
+        EXPECT_EQ(zvmc_register_static_vm("module_vm", create_static_vm), 1);
+    };
+    EXPECT_EQ(zvmc_load("path", nullptr), &create_aaa);
+    EXPECT_EQ(zvmc_find_static_vm("module_vm"), &create_static_vm);
+
+    // The module destructor unregisters the VM, the other VMs are still found after unloading.
+    zvmc_test_library_destructor = [] { EXPECT_EQ(zvmc_unregister_static_vm("module_vm"), 1); };
+    EXPECT_EQ(zvmc_release("path", 1), 0);
+    EXPECT_TRUE(zvmc_find_static_vm("module_vm") == nullptr);
+    EXPECT_EQ(zvmc_find_static_vm("startup_vm"), &create_registered_at_startup);
+    EXPECT_EQ(zvmc_unregister_static_vm("module_vm"), 0);
+    EXPECT_EQ(zvmc_unregister_static_vm(nullptr), 0);
+}
+
+TEST_F(loader, static_vm_name_copied)
+{
+    setup(nullptr, nullptr, nullptr);
+
+    // The name is copied, so the lookups do not read the memory of the caller (e.g. of
+    // a module which has been unloaded without unregistering its VM).
+    char name[] = "copied_vm";
+    EXPECT_EQ(zvmc_register_static_vm(name, create_static_vm), 1);
+    name[0] = 'x';
+    EXPECT_EQ(zvmc_find_static_vm("copied_vm"), &create_static_vm);
+    EXPECT_TRUE(zvmc_find_static_vm(name) == nullptr);
+    EXPECT_EQ(zvmc_find_static_vm("startup_vm"), &create_registered_at_startup);
+
+    // Unregistering keeps the order and the names of the other VMs.
+    EXPECT_EQ(zvmc_register_static_vm("second_vm", create_aaa), 1);
+    EXPECT_EQ(zvmc_unregister_static_vm("copied_vm"), 1);
+    EXPECT_EQ(zvmc_find_static_vm("second_vm"), &create_aaa);
+    EXPECT_EQ(zvmc_unregister_static_vm("second_vm"), 1);
+}
+
+TEST_F(loader, static_vm_registered_at_startup)
+{
+    setup(nullptr, nullptr, nullptr);
+
+    EXPECT_EQ(zvmc_find_static_vm("startup_vm"), &create_registered_at_startup);
+    EXPECT_EQ(zvmc_load_and_create("static:startup_vm", nullptr), create_static_vm());
+}
+
+TEST_F(loader, load_from_module_destructor)
+{
+    setup("path", "zvmc_create", create_aaa);
+    zvmc_test_close_count = 0;
+
+    // The module is closed without the registry lock held, so its destructor may use the loader.
+    EXPECT_EQ(zvmc_load("path", nullptr), &create_aaa);
+    zvmc_test_library_destructor = [] {
+        EXPECT_EQ(zvmc_find_static_vm("startup_vm"), &create_registered_at_startup);
+        EXPECT_EQ(zvmc_release("path", 1), -1);
+    };
+    EXPECT_EQ(zvmc_release("path", 1), 0);
+    EXPECT_EQ(zvmc_test_close_count, 1);
+    EXPECT_TRUE(zvmc_test_library_destructor == nullptr);
+}
+
+TEST_F(loader, option_set)
+{
+    supported_options["a"] = {"_a"};
+    supported_options["b"] = {"", "_b"};
+    setup("path", "zvmc_create", create_vm_with_set_option);
+
+    zvmc_loader_error_code ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
+    auto* const options = zvmc_parse_options("path?bind=now,a=_a,b,b=_b,", &ec);
+    ASSERT_TRUE(options != nullptr);
+    EXPECT_EQ(ec, ZVMC_LOADER_SUCCESS);
+    EXPECT_STREQ(zvmc_option_set_path(options), "path");
+
+    for (int i = 0; i < 3; ++i)
+    {
+        recorded_options.clear();
+        auto vm = zvmc_create_with_options(options, &ec);
+        EXPECT_TRUE(vm);
+        EXPECT_EQ(ec, ZVMC_LOADER_SUCCESS);
+        EXPECT_EQ(zvmc_test_library_flags, 1);
+        ASSERT_EQ(recorded_options.size(), size_t{3});
+        EXPECT_EQ(recorded_options[0], (std::pair<std::string, std::string>{"a", "_a"}));
+        EXPECT_EQ(recorded_options[1], (std::pair<std::string, std::string>{"b", ""}));
+        EXPECT_EQ(recorded_options[2], (std::pair<std::string, std::string>{"b", "_b"}));
+        zvmc_destroy(vm);
+    }
+    EXPECT_EQ(create_count, 3);
+    EXPECT_EQ(destroy_count, 3);
+
+    recorded_options.clear();
+    EXPECT_EQ(zvmc_apply_options(options, create_vm_with_set_option()), ZVMC_LOADER_SUCCESS);
+    EXPECT_EQ(recorded_options.size(), size_t{3});
+    EXPECT_EQ(zvmc_apply_options(options, create_vm_barebone()), ZVMC_LOADER_INVALID_OPTION_NAME);
+    EXPECT_STREQ(zvmc_last_error_msg(), "vm_barebone (path) does not support any options");
+    zvmc_free_options(options);
+}
+
+TEST_F(loader, option_set_errors)
+{
+    supported_options["a"] = {"_a"};
+    setup("path", "zvmc_create", create_vm_with_set_option);
+
+    zvmc_loader_error_code ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
+    EXPECT_TRUE(zvmc_parse_options(nullptr, &ec) == nullptr);
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_ARGUMENT);
+    EXPECT_STREQ(zvmc_last_error_msg(), "invalid argument: configuration cannot be null");
+
+    EXPECT_TRUE(zvmc_parse_options("path?bind=x,a=_a", &ec) == nullptr);
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_OPTION_VALUE);
+    EXPECT_STREQ(zvmc_last_error_msg(), "path: unsupported value 'x' for loader option 'bind'");
+
+    // The VM options are validated by the VM.
+    auto* options = zvmc_parse_options("path,a=_b", &ec);
+    ASSERT_TRUE(options != nullptr);
+    EXPECT_TRUE(zvmc_create_with_options(options, &ec) == nullptr);
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_OPTION_VALUE);
+    EXPECT_STREQ(zvmc_last_error_msg(),
+                 "vm_with_set_option (path): unsupported value '_b' for option 'a'");
+    EXPECT_EQ(destroy_count, create_count);
+    EXPECT_EQ(zvmc_release("path", 0), 0);
+    zvmc_free_options(options);
+
+    options = zvmc_parse_options("nonexistent", &ec);
+    ASSERT_TRUE(options != nullptr);
+    EXPECT_TRUE(zvmc_create_with_options(options, &ec) == nullptr);
+    EXPECT_EQ(ec, ZVMC_LOADER_CANNOT_OPEN);
+    zvmc_free_options(options);
+    zvmc_free_options(nullptr);
+
+    // The configuration length is not limited.
+    auto config = std::string{"path,"};
+    config.append(10000, 'x');
+    options = zvmc_parse_options(config.c_str(), &ec);
+    ASSERT_TRUE(options != nullptr);
+    EXPECT_TRUE(zvmc_create_with_options(options, &ec) == nullptr);
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_OPTION_NAME);
+    ASSERT_EQ(recorded_options.size(), size_t{2});
+    EXPECT_EQ(recorded_options[1].first.size(), size_t{10000});
+    zvmc_free_options(options);
+}
+
+TEST_F(loader, option_set_cpp)
+{
+    supported_options["a"] = {"_a"};
+    setup("path", "zvmc_create", create_vm_with_set_option);
+
+    const zvmc::OptionSet options{"path,a=_a"};
+    ASSERT_TRUE(options);
+    EXPECT_STREQ(options.path(), "path");
+    auto vm = options.create();
+    EXPECT_TRUE(vm);
+    EXPECT_EQ(recorded_options.size(), size_t{1});
+    EXPECT_EQ(options.apply(vm), ZVMC_LOADER_SUCCESS);
+    EXPECT_EQ(recorded_options.size(), size_t{2});
+
+    zvmc_loader_error_code ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
+    const zvmc::OptionSet invalid{"path?x", &ec};
+    EXPECT_FALSE(invalid);
+    EXPECT_EQ(ec, ZVMC_LOADER_INVALID_OPTION_NAME);
+}
@@ -0,0 +1,208 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include "examples/example_vm/example_vm.h"
+#include <zvmc/hex.hpp>
+#include <zvmc/mocked_host.hpp>
+#include <zvmc/recording_host.hpp>
+#include <gtest/gtest.h>
+#include <iterator>
+#include <sstream>
+
+using namespace zvmc;
+using namespace zvmc::literals;
+
+namespace
+{
+constexpr auto addr = "Z00000000000000000000000000000000000000c0"_address;
+constexpr auto key = 0x01_bytes32;
+constexpr auto value = 0x02_bytes32;
+
+/// Requests all kinds of Host calls.
+void call_all(Host& host)
+{
+    const bytes32 topics[] = {key, value};
+    const uint8_t input[] = {1, 2, 3};
+    uint8_t buffer[8]{};
+    zvmc_message msg{};
+    msg.gas = 100;
+    msg.recipient = addr;
+    msg.input_data = input;
+    msg.input_size = sizeof(input);
+
+    host.account_exists(addr);
+    host.access_account(addr);
+    host.access_storage(addr, key);
+    host.get_storage(addr, key);
+    host.set_storage(addr, key, value);
+    host.get_balance(addr);
+    host.get_code_size(addr);
+    host.get_code_hash(addr);
+    host.copy_code(addr, 1, buffer, sizeof(buffer));
+    host.call(msg);
+    host.get_tx_context();
+    host.get_block_hash(7);
+    host.emit_log(addr, input, sizeof(input), topics, std::size(topics));
+}
+
+MockedHost make_host()
+{
+    MockedHost host;
+    host.accounts[addr].code = {0x60, 0x00, 0x60, 0x01};
+    host.accounts[addr].codehash = 0xc0de_bytes32;
+    host.accounts[addr].set_balance(9);
+    host.accounts[addr].storage[key] = 0x05_bytes32;
+    host.tx_context.block_number = 10;
+    host.block_hash = 0xb10c_bytes32;
+    host.call_result.status_code = ZVMC_REVERT;
+    host.call_result.gas_left = 11;
+    return host;
+}
+}  // namespace
+
+TEST(recording_host, record_replay)
+{
+    auto mocked_host = make_host();
+    std::stringstream record;
+    {
+        RecordingHost<MockedHost> recorder{mocked_host, record};
+        call_all(recorder);
+    }
+
+    ReplayHost replay{record};
+    EXPECT_FALSE(replay.finished());
+    EXPECT_TRUE(replay.account_exists(addr));
+    EXPECT_EQ(replay.access_account(addr), ZVMC_ACCESS_WARM);
+    EXPECT_EQ(replay.access_storage(addr, key), ZVMC_ACCESS_COLD);
+    EXPECT_EQ(replay.get_storage(addr, key), 0x05_bytes32);
+    EXPECT_EQ(replay.set_storage(addr, key, value), ZVMC_STORAGE_MODIFIED);
+    EXPECT_EQ(replay.get_balance(addr), 0x09_bytes32);
+    EXPECT_EQ(replay.get_code_size(addr), 4u);
+    EXPECT_EQ(replay.get_code_hash(addr), 0xc0de_bytes32);
+    uint8_t buffer[8]{};
+    EXPECT_EQ(replay.copy_code(addr, 1, buffer, sizeof(buffer)), 3u);
+    EXPECT_EQ(bytes(buffer, 3), (bytes{0x00, 0x60, 0x01}));
+
+    const uint8_t input[] = {1, 2, 3};
+    zvmc_message msg{};
+    msg.gas = 100;
+    msg.recipient = addr;
+    msg.input_data = input;
+    msg.input_size = sizeof(input);
+    const auto result = replay.call(msg);
+    EXPECT_EQ(result.status_code, ZVMC_REVERT);
+    EXPECT_EQ(result.gas_left, 11);
+
+    EXPECT_EQ(replay.get_tx_context().block_number, 10);
+    EXPECT_EQ(replay.get_block_hash(7), 0xb10c_bytes32);
+    const bytes32 topics[] = {key, value};
+    replay.emit_log(addr, input, sizeof(input), topics, std::size(topics));
+    EXPECT_TRUE(replay.finished());
+    EXPECT_FALSE(replay.diverged());
+
+    // The replay can be repeated.
+    replay.rewind();
+    call_all(replay);
+    EXPECT_TRUE(replay.finished());
+}
+
+TEST(recording_host, small_buffer)
+{
+    auto host_a = make_host();
+    auto host_b = make_host();
+    std::stringstream record_a;
+    std::stringstream record_b;
+    {
+        RecordingHost<HostInterface> recorder_a{host_a, record_a};
+        RecordingHost<HostInterface> recorder_b{host_b, record_b, 5};
+        call_all(recorder_a);
+        call_all(recorder_b);
+    }
+    EXPECT_EQ(record_a.str(), record_b.str());
+}
+
+TEST(recording_host, diverged)
+{
+    auto mocked_host = make_host();
+    std::stringstream record;
+    {
+        RecordingHost<MockedHost> recorder{mocked_host, record};
+        recorder.get_storage(addr, key);
+        recorder.get_balance(addr);
+    }
+
+    ReplayHost replay{record};
+    EXPECT_EQ(replay.get_storage(addr, value), bytes32{});
+    EXPECT_TRUE(replay.diverged());
+    EXPECT_EQ(replay.get_balance(addr), bytes32{});
+    EXPECT_FALSE(replay.finished());
+
+    replay.rewind();
+    EXPECT_EQ(replay.get_balance(addr), bytes32{});
+    EXPECT_TRUE(replay.diverged());
+
+    replay.rewind();
+    EXPECT_EQ(replay.get_storage(addr, key), 0x05_bytes32);
+    EXPECT_EQ(replay.get_balance(addr), 0x09_bytes32);
+    EXPECT_TRUE(replay.finished());
+
+    // Requesting more calls than recorded.
+    EXPECT_EQ(replay.get_balance(addr), bytes32{});
+    EXPECT_TRUE(replay.diverged());
+}
+
+TEST(recording_host, invalid_record)
+{
+    ReplayHost empty{bytes{}};
+    EXPECT_TRUE(empty.diverged());
+    EXPECT_FALSE(empty.account_exists(addr));
+
+    ReplayHost truncated{bytes{'Z', 'V', 'M', 'H', 1, uint8_t(HostCall::get_code_size)}};
+    EXPECT_FALSE(truncated.diverged());
+    EXPECT_EQ(truncated.get_code_size({}), 0u);
+    EXPECT_TRUE(truncated.diverged());
+}
+
+TEST(recording_host, example_vm)
+{
+    // Adds the block number to the storage slot 0, calls the account 0xaa
+    // and returns 32 bytes of the call output.
+    const auto code = *from_hex(
+        "600054430160005560206000600060006000"
+        "60aa60fff1"
+        "60206000f3");
+    const auto call_output = 0xca11_bytes32;
+
+    auto mocked_host = make_host();
+    mocked_host.accounts[addr].storage[{}] = 0x05_bytes32;
+    mocked_host.call_result.status_code = ZVMC_SUCCESS;
+    mocked_host.call_result.output_data = call_output.bytes;
+    mocked_host.call_result.output_size = sizeof(call_output);
+
+    auto vm = VM{zvmc_create_example_vm()};
+    zvmc_message msg{};
+    msg.gas = 1000;
+    msg.recipient = addr;
+
+    std::stringstream record;
+    bytes expected_output;
+    {
+        RecordingHost<MockedHost> recorder{mocked_host, record};
+        const auto result = vm.execute(recorder, ZVMC_SHANGHAI, msg, code.data(), code.size());
+        ASSERT_EQ(result.status_code, ZVMC_SUCCESS);
+        expected_output.assign(result.output_data, result.output_size);
+    }
+    EXPECT_EQ(expected_output, bytes{call_output});
+
+    ReplayHost replay{record};
+    for (int i = 0; i < 2; ++i)
+    {
+        const auto result = vm.execute(replay, ZVMC_SHANGHAI, msg, code.data(), code.size());
+        EXPECT_EQ(result.status_code, ZVMC_SUCCESS);
+        EXPECT_EQ(result.gas_left, 1000 - 17);
+        EXPECT_EQ(bytes(result.output_data, result.output_size), expected_output);
+        EXPECT_TRUE(replay.finished());
+        replay.rewind();
+    }
+}
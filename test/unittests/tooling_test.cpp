@@ -2,17 +2,51 @@
 // Copyright 2020 The EVMC Authors.
 // Licensed under the Apache License, Version 2.0.
 
+#include "examples/example_precompiles_vm/example_precompiles_vm.h"
 #include "examples/example_vm/example_vm.h"
 #include <zvmc/hex.hpp>
 #include <zvmc/tooling.hpp>
 #include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
 #include <sstream>
 
 using namespace zvmc::tooling;
 using zvmc::from_hex;
+namespace fs = std::filesystem;
 
 namespace
 {
+/// The uniquely named temporary directory, removed with its content at the end of the scope.
+class TempDir
+{
+    fs::path m_path;
+
+public:
+    /// Creates the directory with the @p name followed by a random suffix.
+    explicit TempDir(const std::string& name)
+    {
+        std::random_device rd;
+        do
+        {
+            m_path = fs::temp_directory_path() / (name + "_" + std::to_string(rd()));
+        } while (!fs::create_directory(m_path));
+    }
+
+    ~TempDir()
+    {
+        std::error_code ec;
+        fs::remove_all(m_path, ec);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    /// The path of the directory.
+    const fs::path& path() const noexcept { return m_path; }
+};
+
 std::string out_pattern(const char* rev,
                         int gas_limit,
                         const char* status,
@@ -173,3 +207,209 @@ TEST(tool_commands, bench_inconsistent_output)
     EXPECT_NE(o.find("Result:   success"), std::string::npos);
     EXPECT_NE(o.find("Gas used: 10"), std::string::npos);
 }
+
+TEST(tool_commands, bench_corpus)
+{
+    const TempDir temp_dir{"zvmc_bench_corpus_test"};
+    const auto& dir = temp_dir.path();
+    fs::create_directories(dir / "a_return_address");
+    fs::create_directories(dir / "b_wrong_output");
+    fs::create_directories(dir / "c_invalid_input");
+    fs::create_directories(dir / "d_missing_code");
+    std::ofstream{dir / "a_return_address" / "code.hex"} << "30600052596000f3";
+    std::ofstream{dir / "b_wrong_output" / "code.hex"} << "0x6002600201\n";
+    std::ofstream{dir / "b_wrong_output" / "expected.hex"} << "ff";
+    std::ofstream{dir / "c_invalid_input" / "code.hex"} << "00";
+    std::ofstream{dir / "c_invalid_input" / "input.hex"} << "0g";
+    std::ofstream{dir / "not_a_contract.txt"} << "ignored";
+
+    auto vm = zvmc::VM{zvmc_create_example_vm()};
+    std::ostringstream out;
+
+    const auto exit_code =
+        bench_corpus(vm, ZVMC_SHANGHAI, 200, dir.string(), std::chrono::milliseconds{1}, out);
+    EXPECT_EQ(exit_code, 1);
+
+    const auto o = out.str();
+    EXPECT_EQ(o.find("Benchmarking 4 contracts on Shanghai with 200 gas limit\n\n"), 0);
+    EXPECT_NE(o.find("a_return_address: success, gas used: 6, time: "), std::string::npos);
+    EXPECT_NE(o.find("b_wrong_output: success, gas used: 3, FAILED (output: )\n"),
+              std::string::npos);
+    EXPECT_NE(o.find("c_invalid_input: FAILED (invalid hex in " +
+                     (dir / "c_invalid_input" / "input.hex").string() + ")\n"),
+              std::string::npos);
+    EXPECT_NE(o.find("d_missing_code: FAILED (cannot open " +
+                     (dir / "d_missing_code" / "code.hex").string() + ")\n"),
+              std::string::npos);
+    EXPECT_NE(o.find("Geometric mean: "), std::string::npos);
+    EXPECT_NE(o.find("(1 contracts)\nFailed: 3 contracts\n"), std::string::npos);
+}
+
+TEST(tool_commands, calibrate)
+{
+    auto vm = zvmc::VM{zvmc_create_example_vm()};
+    std::ostringstream out;
+
+    const auto exit_code = calibrate(vm, ZVMC_SHANGHAI, std::chrono::milliseconds{1}, out);
+    EXPECT_EQ(exit_code, 0);
+
+    const auto o = out.str();
+    EXPECT_EQ(o.find("{\n  \"vm\": \"example_vm\",\n  \"version\": \""), 0);
+    EXPECT_NE(o.find("\",\n  \"revision\": \"Shanghai\",\n  \"repetitions\": 1024,\n"
+                     "  \"sink\": \"JUMPI\",\n  \"opcodes\": [\n"
+                     "    {\"opcode\": \"0x01\", \"name\": \"ADD\", \"status\": \"success\", "
+                     "\"gas\": 1.000, \"ns\": "),
+              std::string::npos);
+    EXPECT_NE(o.find("    {\"opcode\": \"0x57\", \"name\": \"JUMPI\", \"status\": \"success\", "
+                     "\"gas\": 1.000, \"ns\": "),
+              std::string::npos);
+    EXPECT_NE(o.find("\"name\": \"JUMPDEST\", \"status\": \"success\", \"gas\": 1.000, "),
+              std::string::npos);
+    EXPECT_EQ(o.rfind("\"}\n  ]\n}\n"), o.size() - 9);
+
+    // The terminators are not calibrated.
+    EXPECT_EQ(o.find("\"STOP\""), std::string::npos);
+    EXPECT_EQ(o.find("\"RETURN\""), std::string::npos);
+}
+
+TEST(tool_commands, calibrate_invalid_revision)
+{
+    auto vm = zvmc::VM{zvmc_create_example_vm()};
+    std::ostringstream out;
+
+    const auto rev = static_cast<zvmc_revision>(ZVMC_MAX_REVISION + 1);
+    EXPECT_EQ(calibrate(vm, rev, std::chrono::milliseconds{1}, out), 1);
+    EXPECT_EQ(out.str().find("Calibration not supported on "), 0);
+}
+
+TEST(tool_commands, disasm)
+{
+    std::ostringstream out;
+
+    const auto exit_code = disasm(ZVMC_SHANGHAI, *from_hex("60003556005b0c617f"), out);
+    EXPECT_EQ(exit_code, 0);
+    EXPECT_EQ(out.str(),
+              "     0  PUSH1 0x00\n"
+              "     2  CALLDATALOAD\n"
+              "     3  JUMP\n"
+              "     4  STOP\n"
+              "     5  JUMPDEST\n"
+              "     6  0x0c\n"
+              "     7  PUSH2 0x7f (truncated)\n");
+
+    std::ostringstream empty_out;
+    EXPECT_EQ(disasm(ZVMC_SHANGHAI, {}, empty_out), 0);
+    EXPECT_EQ(empty_out.str(), "");
+
+    std::ostringstream invalid_out;
+    const auto rev = static_cast<zvmc_revision>(ZVMC_MAX_REVISION + 1);
+    EXPECT_EQ(disasm(rev, {}, invalid_out), 1);
+    EXPECT_EQ(invalid_out.str().find("Disassembly not supported on "), 0);
+}
+
+TEST(tool_commands, stats)
+{
+    const TempDir temp_dir{"zvmc_stats_test"};
+    const auto& dir = temp_dir.path();
+    fs::create_directories(dir / "contract");
+    std::ofstream{dir / "a.bin", std::ios::binary} << std::string{"\x60\x01\x60\x01\x01", 5};
+    std::ofstream{dir / "contract" / "code.hex"} << "60016001015b00";
+    std::ofstream{dir / "contract" / "input.hex"} << "01010101";
+    std::ofstream{dir / "empty.bin", std::ios::binary};
+
+    std::ostringstream out;
+    const auto exit_code = stats(ZVMC_SHANGHAI, dir.string(), 2, out);
+    EXPECT_EQ(exit_code, 0);
+    EXPECT_EQ(out.str(),
+              "Analyzed 3 files, 8 instructions\n"
+              "\n"
+              "Opcodes:\n"
+              "           4  50.00%  PUSH1\n"
+              "           2  25.00%  ADD\n"
+              "\n"
+              "Pairs:\n"
+              "           2  33.33%  PUSH1 ADD\n"
+              "           2  33.33%  PUSH1 PUSH1\n"
+              "\n"
+              "Triples:\n"
+              "           2  50.00%  PUSH1 PUSH1 ADD\n"
+              "           1  25.00%  ADD JUMPDEST STOP\n");
+}
+
+TEST(tool_commands, compare_same_vm)
+{
+    auto vm_a = zvmc::VM{zvmc_create_example_vm()};
+    auto vm_b = zvmc::VM{zvmc_create_example_vm()};
+    std::ostringstream out;
+
+    const auto exit_code =
+        compare(vm_a, vm_b, ZVMC_SHANGHAI, 200, *from_hex("60028001"), {}, out);
+    EXPECT_EQ(exit_code, 0);
+
+    const auto o = out.str();
+    EXPECT_EQ(o.find("Comparing on Shanghai with 200 gas limit\nA: example_vm "), 0);
+    EXPECT_NE(o.find("\nB: example_vm "), std::string::npos);
+    EXPECT_NE(o.find("\n\nResult:   success\nGas used: 3\nOutput:   \n\nTime A:   "),
+              std::string::npos);
+    EXPECT_NE(o.find("Time B:   "), std::string::npos);
+    EXPECT_NE(o.find("Speedup:  "), std::string::npos);
+    EXPECT_NE(o.find("x (95% CI: "), std::string::npos);
+    EXPECT_NE(o.find(", 30 samples of "), std::string::npos);
+}
+
+TEST(tool_commands, compare_mismatch)
+{
+    auto vm_a = zvmc::VM{zvmc_create_example_vm()};
+    auto vm_b = zvmc::VM{zvmc_create_example_precompiles_vm()};
+    std::ostringstream out;
+
+    const auto exit_code = compare(vm_a, vm_b, ZVMC_SHANGHAI, 200, *from_hex("30600052596000f3"),
+                                   *from_hex("0c49c4"), out);
+    EXPECT_EQ(exit_code, 1);
+
+    const auto o = out.str();
+    EXPECT_NE(o.find("Results mismatch\n"
+                     "A: success, gas used: 6, "
+                     "output: 0000000000000000000000000000000000000000000000000000000000000000\n"
+                     "B: "),
+              std::string::npos);
+}
+
+TEST(tool_commands, load_files)
+{
+    const TempDir temp_dir{"zvmc_load_files_test"};
+    const auto& dir = temp_dir.path();
+    const auto bin_file = (dir / "code.bin").string();
+    const auto hex_file = (dir / "code.hex").string();
+    const auto spaced_hex_file = (dir / "spaced.hex").string();
+    const auto invalid_hex_file = (dir / "invalid.hex").string();
+    const auto non_ascii_hex_file = (dir / "non_ascii.hex").string();
+    const auto empty_file = (dir / "empty").string();
+    std::ofstream{bin_file, std::ios::binary} << std::string{"\x60\x00\n\xf3", 4};
+    std::ofstream{hex_file} << "\n0x600035600052596000f3\n";
+    std::ofstream{spaced_hex_file} << "60 00\n35\t6000 52\n";
+    std::ofstream{invalid_hex_file} << "60 0";
+    // The bytes above 0x7f (negative plain chars) are neither whitespace nor hex digits.
+    std::ofstream{non_ascii_hex_file, std::ios::binary} << "\xa0\xff" "6000";
+    std::ofstream{empty_file};
+
+    {
+        auto file = MappedFile{bin_file};
+        EXPECT_EQ(file.data(), (zvmc::bytes{0x60, 0x00, 0x0a, 0xf3}));
+        const auto moved = std::move(file);
+        EXPECT_EQ(moved.data(), (zvmc::bytes{0x60, 0x00, 0x0a, 0xf3}));
+        EXPECT_TRUE(file.data().empty());  // NOLINT(bugprone-use-after-move)
+        file = MappedFile{hex_file};
+        EXPECT_EQ(file.data().size(), 24u);
+    }
+    EXPECT_TRUE(MappedFile{empty_file}.data().empty());
+    EXPECT_TRUE(MappedFile{}.data().empty());
+    EXPECT_THROW(MappedFile{(dir / "missing").string()}, std::invalid_argument);
+    EXPECT_THROW(MappedFile{dir.string()}, std::invalid_argument);
+
+    EXPECT_EQ(load_hex_file(hex_file), *from_hex("600035600052596000f3"));
+    EXPECT_EQ(load_hex_file(spaced_hex_file), *from_hex("600035600052"));
+    EXPECT_EQ(load_hex_file(empty_file), zvmc::bytes{});
+    EXPECT_THROW(load_hex_file(invalid_hex_file), std::invalid_argument);
+    EXPECT_THROW(load_hex_file(non_ascii_hex_file), std::invalid_argument);
+}
@@ -0,0 +1,265 @@
+// EVMC: Ethereum Client-VM Connector API.
+// Copyright 2026 The EVMC Authors.
+// Licensed under the Apache License, Version 2.0.
+
+#include "examples/example_vm/example_vm.h"
+#include <zvmc/hex.hpp>
+#include <zvmc/mocked_host.hpp>
+#include <zvmc/recording_host.hpp>
+#include <zvmc/tooling.hpp>
+#include <zvmc/trace.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+using namespace zvmc;
+using namespace zvmc::literals;
+
+namespace
+{
+constexpr auto recipient = "Z00000000000000000000000000000000000000c0"_address;
+
+/// Adds the block number to the storage slot 0, calls the account 0xaa
+/// and returns 32 bytes of the call output.
+const auto code = *from_hex(
+    "600054430160005560206000600060006000"
+    "60aa60fff1"
+    "60206000f3");
+
+/// The output of the call to the account 0xaa.
+constexpr auto call_output =
+    0xca11ca11ca11ca11ca11ca11ca11ca11ca11ca11ca11ca11ca11ca11ca11ca11_bytes32;
+
+Trace record_trace()
+{
+    MockedHost host;
+    host.tx_context.block_number = 10;
+    host.accounts[recipient].storage[{}] = 0x05_bytes32;
+    host.call_result.output_data = call_output.bytes;
+    host.call_result.output_size = sizeof(call_output);
+
+    auto vm = VM{zvmc_create_example_vm()};
+    Trace trace;
+    TraceRecorder recorder{host, trace};
+
+    zvmc_message msg{};
+    msg.gas = 1000;
+    msg.recipient = recipient;
+    for (int i = 0; i < 2; ++i)
+    {
+        const auto result = recorder.execute(vm, ZVMC_SHANGHAI, msg, code);
+        EXPECT_EQ(result.status_code, ZVMC_SUCCESS);
+    }
+    EXPECT_EQ(host.accounts[recipient].storage[{}].current, 0x19_bytes32);
+    return trace;
+}
+
+/// Executes the VM reporting the answers of the Host to the account and storage queries
+/// in the output.
+zvmc_result execute_queries(zvmc_vm* /*vm*/,
+                            const zvmc_host_interface* host,
+                            zvmc_host_context* context,
+                            zvmc_revision /*rev*/,
+                            const zvmc_message* msg,
+                            const uint8_t* /*code*/,
+                            size_t /*code_size*/) noexcept
+{
+    const bytes32 key{};
+    const uint8_t output[] = {
+        static_cast<uint8_t>(host->access_account(context, &msg->recipient)),
+        static_cast<uint8_t>(host->access_account(context, &msg->recipient)),
+        static_cast<uint8_t>(host->access_storage(context, &msg->recipient, &key)),
+        static_cast<uint8_t>(host->access_storage(context, &msg->recipient, &key)),
+        static_cast<uint8_t>(host->account_exists(context, &msg->recipient)),
+        static_cast<uint8_t>(host->account_exists(context, &msg->sender)),
+        static_cast<uint8_t>(host->get_tx_context(context).block_number),
+        host->get_code_hash(context, &msg->recipient).bytes[31],
+    };
+    return zvmc_make_result(ZVMC_SUCCESS, msg->gas, 0, output, sizeof(output));
+}
+
+zvmc_vm* create_queries_vm()
+{
+    static auto instance = zvmc_vm{
+        ZVMC_ABI_VERSION, "queries", "", [](zvmc_vm*) {}, execute_queries, nullptr, nullptr};
+    return &instance;
+}
+}  // namespace
+
+TEST(trace, record)
+{
+    const auto trace = record_trace();
+
+    ASSERT_EQ(trace.messages.size(), 2u);
+    for (const auto& m : trace.messages)
+    {
+        EXPECT_EQ(m.rev, ZVMC_SHANGHAI);
+        EXPECT_EQ(address{m.msg.recipient}, recipient);
+        EXPECT_EQ(m.code, code);
+        EXPECT_EQ(m.result.status_code, ZVMC_SUCCESS);
+        EXPECT_EQ(m.result.output, bytes{call_output});
+    }
+
+    // The Host calls of every message are recorded separately.
+    ReplayHost first{trace.messages[0].host_calls};
+    EXPECT_EQ(first.get_storage(recipient, {}), 0x05_bytes32);
+    EXPECT_EQ(first.get_tx_context().block_number, 10);
+    EXPECT_EQ(first.set_storage(recipient, {}, 0x0f_bytes32), ZVMC_STORAGE_MODIFIED);
+    EXPECT_FALSE(first.diverged());
+
+    ReplayHost second{trace.messages[1].host_calls};
+    EXPECT_EQ(second.get_storage(recipient, {}), 0x0f_bytes32);
+}
+
+TEST(trace, write_read)
+{
+    const auto trace = record_trace();
+
+    std::stringstream buffer;
+    write_trace(buffer, trace);
+    const auto loaded = read_trace(buffer);
+
+    ASSERT_EQ(loaded.messages.size(), trace.messages.size());
+    for (size_t i = 0; i < trace.messages.size(); ++i)
+    {
+        const auto& a = loaded.messages[i];
+        const auto& b = trace.messages[i];
+        EXPECT_EQ(a.rev, b.rev);
+        EXPECT_EQ(a.msg.gas, b.msg.gas);
+        EXPECT_EQ(address{a.msg.recipient}, address{b.msg.recipient});
+        EXPECT_EQ(a.code, b.code);
+        EXPECT_EQ(a.input, b.input);
+        EXPECT_EQ(a.host_calls, b.host_calls);
+        EXPECT_EQ(a.result.status_code, b.result.status_code);
+        EXPECT_EQ(a.result.gas_left, b.result.gas_left);
+        EXPECT_EQ(a.result.output, b.result.output);
+    }
+}
+
+TEST(trace, read_invalid)
+{
+    std::istringstream empty;
+    EXPECT_THROW(read_trace(empty), std::invalid_argument);
+
+    std::istringstream bad_magic{"ZVMX\x02"};
+    EXPECT_THROW(read_trace(bad_magic), std::invalid_argument);
+
+    std::istringstream bad_version{"ZVMT\x01"};
+    EXPECT_THROW(read_trace(bad_version), std::invalid_argument);
+
+    // The number of messages is checked against the input size before allocating them.
+    std::istringstream too_many_messages{"ZVMT\x02" + std::string(7, '\xff') + '\x7f'};
+    EXPECT_THROW(read_trace(too_many_messages), std::invalid_argument);
+
+    std::stringstream truncated;
+    write_trace(truncated, record_trace());
+    auto data = truncated.str();
+    data.pop_back();
+    std::istringstream in{data};
+    EXPECT_THROW(read_trace(in), std::invalid_argument);
+}
+
+TEST(trace, replay)
+{
+    const auto trace = record_trace();
+    auto vm = VM{zvmc_create_example_vm()};
+    std::ostringstream out;
+
+    EXPECT_EQ(tooling::replay(vm, trace, false, out), 0);
+    EXPECT_EQ(out.str(),
+              "Replaying 2 messages\n"
+              "Message 0: success, gas used: 17\n"
+              "Message 1: success, gas used: 17\n");
+}
+
+TEST(trace, replay_mismatch)
+{
+    auto trace = record_trace();
+    trace.messages[1].result.gas_left += 1;
+    // The recorded storage value written by the first message is changed.
+    auto& host_calls = trace.messages[0].host_calls;
+    const auto set_storage_value = host_calls.find(bytes{0x0f_bytes32});
+    ASSERT_NE(set_storage_value, bytes::npos);
+    host_calls[set_storage_value + 31] = 0x01;
+    auto vm = VM{zvmc_create_example_vm()};
+    std::ostringstream out;
+
+    EXPECT_EQ(tooling::replay(vm, trace, true, out), 1);
+    const auto o = out.str();
+    // The diverged replay returns the failed call, so also the output differs.
+    EXPECT_NE(o.find("  got:      success, gas used: 17, output: 0000"), std::string::npos);
+    EXPECT_NE(o.find("  the Host calls do not match the recorded ones\n"
+                     "Message 1: success, gas used: 17, FAILED\n"
+                     "  expected: success, gas used: 16, output: ca11"),
+              std::string::npos);
+    EXPECT_NE(o.find("Failed: 2 mismatches\n"), std::string::npos);
+    EXPECT_EQ(o.find("Time:"), std::string::npos);
+}
+
+TEST(trace, replay_result_mismatch)
+{
+    auto trace = record_trace();
+    trace.messages[0].result.gas_refund = 1;
+    trace.messages[1].result.create_address = "Z0000000000000000000000000000000000000001"_address;
+    auto vm = VM{zvmc_create_example_vm()};
+    std::ostringstream out;
+
+    EXPECT_EQ(tooling::replay(vm, trace, false, out), 1);
+    const auto o = out.str();
+    const auto output = hex(bytes_view{call_output.bytes, sizeof(call_output.bytes)});
+    const auto zero_address = std::string(40, '0');
+    EXPECT_NE(o.find("Message 0: success, gas used: 17, FAILED\n"
+                     "  expected: success, gas used: 17, output: " +
+                     output + ", gas refund: 1, create address: " + zero_address +
+                     "\n"
+                     "  got:      success, gas used: 17, output: " +
+                     output + ", gas refund: 0, create address: " + zero_address + "\n"),
+              std::string::npos)
+        << o;
+    EXPECT_NE(o.find("  expected: success, gas used: 17, output: " + output +
+                     ", gas refund: 0, create address: " + std::string(39, '0') + "1\n"),
+              std::string::npos)
+        << o;
+    EXPECT_NE(o.find("Failed: 2 mismatches\n"), std::string::npos);
+}
+
+TEST(trace, replay_bench)
+{
+    const auto trace = record_trace();
+    auto vm = VM{zvmc_create_example_vm()};
+    std::ostringstream out;
+
+    EXPECT_EQ(tooling::replay(vm, trace, true, out), 0);
+    EXPECT_NE(out.str().find("Time:     "), std::string::npos);
+    EXPECT_NE(out.str().find(" iterations)\n"), std::string::npos);
+}
+
+TEST(trace, replay_queries)
+{
+    MockedHost host;
+    host.accounts[recipient].codehash = 0xc0de_bytes32;
+    auto vm = VM{create_queries_vm()};
+    Trace trace;
+    TraceRecorder recorder{host, trace};
+
+    zvmc_message msg{};
+    msg.recipient = recipient;
+    for (int i = 0; i < 2; ++i)
+    {
+        host.tx_context.block_number = 10 + i;
+        recorder.execute(vm, ZVMC_SHANGHAI, msg, {});
+    }
+
+    // The account and the storage key are warm in the second message.
+    ASSERT_EQ(trace.messages.size(), 2u);
+    EXPECT_EQ(hex(trace.messages[0].result.output), "0001000101000ade");
+    EXPECT_EQ(hex(trace.messages[1].result.output), "0101010101000bde");
+
+    std::stringstream buffer;
+    write_trace(buffer, trace);
+    std::ostringstream out;
+    EXPECT_EQ(tooling::replay(vm, read_trace(buffer), false, out), 0);
+    EXPECT_EQ(out.str(),
+              "Replaying 2 messages\n"
+              "Message 0: success, gas used: 0\n"
+              "Message 1: success, gas used: 0\n");
+}
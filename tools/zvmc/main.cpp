@@ -6,34 +6,64 @@
 #include <zvmc/hex.hpp>
 #include <zvmc/loader.h>
 #include <zvmc/tooling.hpp>
+#include <zvmc/trace.hpp>
 #include <fstream>
+#include <vector>
 
 namespace
 {
-/// If the argument starts with @ returns the hex-decoded contents of the file
-/// at the path following the @. Otherwise, returns the argument.
-/// @todo The file content is expected to be a hex string but not validated.
-zvmc::bytes load_from_hex(const std::string& str)
+/// The bytes of the code or input argument.
+///
+/// If the argument starts with @@ the bytes are the raw contents of the file at the path
+/// following the @@. The file is memory-mapped, not copied.
+/// If the argument starts with @ the bytes are the hex-decoded contents of the file at the path
+/// following the @. Otherwise, the argument is hex-decoded.
+class ArgumentBytes
 {
-    if (str[0] == '@')  // The argument is file path.
+    zvmc::bytes m_decoded;
+    zvmc::tooling::MappedFile m_file;
+
+public:
+    explicit ArgumentBytes(const std::string& str)
+    {
+        if (str.rfind("@@", 0) == 0)  // The argument is binary file path.
+            m_file = zvmc::tooling::MappedFile{str.substr(2)};
+        else if (str.rfind('@', 0) == 0)  // The argument is hex file path.
+            m_decoded = zvmc::tooling::load_hex_file(str.substr(1));
+        else
+            m_decoded = zvmc::from_hex(str).value();  // Should be validated already.
+    }
+
+    operator zvmc::bytes_view() const noexcept  // NOLINT(hicpp-explicit-conversions)
     {
-        const auto path = str.substr(1);
-        std::ifstream file{path};
-        auto out = zvmc::from_spaced_hex(std::istreambuf_iterator<char>{file},
-                                         std::istreambuf_iterator<char>{});
-        if (!out)
-            throw std::invalid_argument{"invalid hex in " + path};
-        return out.value();
+        return m_decoded.empty() ? m_file.data() : zvmc::bytes_view{m_decoded};
     }
+};
 
-    return zvmc::from_hex(str).value();  // Should be validated already.
+/// Loads and configures the VM from the config string.
+/// In case of error, the error message is printed to stderr and @p ec is set.
+zvmc::VM load_vm(const std::string& config, zvmc_loader_error_code& ec)
+{
+    ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
+    auto vm = zvmc::VM{zvmc_load_and_configure(config.c_str(), &ec)};
+    if (ec != ZVMC_LOADER_SUCCESS)
+    {
+        const auto error = zvmc_last_error_msg();
+        if (error != nullptr)
+            std::cerr << error << "\n";
+        else
+            std::cerr << "Loading error " << ec << "\n";
+    }
+    return vm;
 }
 
 struct HexOrFileValidator : public CLI::Validator
 {
-    HexOrFileValidator() : CLI::Validator{"HEX|@FILE"}
+    HexOrFileValidator() : CLI::Validator{"HEX|@FILE|@@BINFILE"}
     {
         func_ = [](const std::string& str) -> std::string {
+            if (str.rfind("@@", 0) == 0)
+                return CLI::ExistingFile(str.substr(2));
             if (!str.empty() && str[0] == '@')
                 return CLI::ExistingFile(str.substr(1));
             if (!zvmc::validate_hex(str))
@@ -59,6 +89,11 @@ int main(int argc, const char** argv) noexcept
         std::string input_arg;
         auto create = false;
         auto bench = false;
+        std::string corpus_dir;
+        int64_t bench_time_ms = 1000;
+        std::vector<std::string> compare_vm_configs;
+        std::string trace_file;
+        size_t stats_top = 20;
 
         CLI::App app{"ZVMC tool"};
         const auto& version_flag = *app.add_flag("--version", "Print version information and exit");
@@ -79,6 +114,63 @@ int main(int argc, const char** argv) noexcept
             "--bench", bench,
             "Benchmark execution time (state modification may result in unexpected behaviour)");
 
+        auto& bench_corpus_cmd =
+            *app.add_subcommand("bench-corpus", "Benchmark ZVM bytecode corpus")->fallthrough();
+        bench_corpus_cmd
+            .add_option("dir", corpus_dir,
+                        "Directory with contract subdirectories (code.hex, input.hex, expected.hex)")
+            ->required()
+            ->check(CLI::ExistingDirectory);
+        bench_corpus_cmd.add_option("--gas", gas, "Execution gas limit")
+            ->capture_default_str()
+            ->check(CLI::Range(0, 1000000000));
+        bench_corpus_cmd.add_option("--rev", rev, "ZVM revision")->capture_default_str();
+        bench_corpus_cmd
+            .add_option("--time", bench_time_ms, "Benchmark time per contract in milliseconds")
+            ->capture_default_str()
+            ->check(CLI::Range(int64_t{1}, int64_t{3600000}));
+
+        auto& calibrate_cmd =
+            *app.add_subcommand("calibrate", "Measure execution time per gas of every opcode")
+                 ->fallthrough();
+        calibrate_cmd.add_option("--rev", rev, "ZVM revision")->capture_default_str();
+        calibrate_cmd
+            .add_option("--time", bench_time_ms, "Benchmark time per opcode in milliseconds")
+            ->capture_default_str()
+            ->check(CLI::Range(int64_t{1}, int64_t{3600000}));
+
+        auto& compare_cmd =
+            *app.add_subcommand("compare", "Compare execution of ZVM bytecode by two VMs");
+        compare_cmd.add_option("--vm", compare_vm_configs, "ZVMC VM modules A and B")
+            ->required();
+        compare_cmd.add_option("code", code_arg, "Bytecode")->required()->check(HexOrFile);
+        compare_cmd.add_option("--gas", gas, "Execution gas limit")
+            ->capture_default_str()
+            ->check(CLI::Range(0, 1000000000));
+        compare_cmd.add_option("--rev", rev, "ZVM revision")->capture_default_str();
+        compare_cmd.add_option("--input", input_arg, "Input bytes")->check(HexOrFile);
+
+        auto& disasm_cmd = *app.add_subcommand("disasm", "Disassemble ZVM bytecode");
+        disasm_cmd.add_option("code", code_arg, "Bytecode")->required()->check(HexOrFile);
+        disasm_cmd.add_option("--rev", rev, "ZVM revision")->capture_default_str();
+
+        auto& stats_cmd =
+            *app.add_subcommand("stats", "Print instruction histograms of ZVM bytecode corpus");
+        stats_cmd.add_option("dir", corpus_dir, "Directory with *.bin and code.hex files")
+            ->required()
+            ->check(CLI::ExistingDirectory);
+        stats_cmd.add_option("--rev", rev, "ZVM revision")->capture_default_str();
+        stats_cmd.add_option("--top", stats_top, "Number of the most frequent entries printed")
+            ->capture_default_str()
+            ->check(CLI::Range(size_t{1}, size_t{1} << 24));
+
+        auto& replay_cmd =
+            *app.add_subcommand("replay", "Replay recorded ZVM execution trace")->fallthrough();
+        replay_cmd.add_option("trace", trace_file, "Binary trace file")
+            ->required()
+            ->check(CLI::ExistingFile);
+        replay_cmd.add_flag("--bench", bench, "Benchmark the replay of the whole trace");
+
         try
         {
             app.parse(argc, argv);
@@ -87,16 +179,9 @@ int main(int argc, const char** argv) noexcept
             if (vm_option.count() != 0)
             {
                 zvmc_loader_error_code ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
-                vm = VM{zvmc_load_and_configure(vm_config.c_str(), &ec)};
+                vm = load_vm(vm_config, ec);
                 if (ec != ZVMC_LOADER_SUCCESS)
-                {
-                    const auto error = zvmc_last_error_msg();
-                    if (error != nullptr)
-                        std::cerr << error << "\n";
-                    else
-                        std::cerr << "Loading error " << ec << "\n";
                     return static_cast<int>(ec);
-                }
             }
 
             // Handle the --version flag first and exit when present.
@@ -121,11 +206,77 @@ int main(int argc, const char** argv) noexcept
                 std::cout << "Config: " << vm_config << "\n";
 
                 // If code_arg or input_arg contains invalid hex string an exception is thrown.
-                const auto code = load_from_hex(code_arg);
-                const auto input = load_from_hex(input_arg);
+                const ArgumentBytes code{code_arg};
+                const ArgumentBytes input{input_arg};
                 return tooling::run(vm, rev, gas, code, input, create, bench, std::cout);
             }
 
+            if (bench_corpus_cmd)
+            {
+                // For bench-corpus command the --vm is required.
+                if (vm_option.count() == 0)
+                    throw CLI::RequiredError{vm_option.get_name()};
+
+                std::cout << "Config: " << vm_config << "\n";
+
+                return tooling::bench_corpus(vm, rev, gas, corpus_dir,
+                                             std::chrono::milliseconds{bench_time_ms}, std::cout);
+            }
+
+            if (calibrate_cmd)
+            {
+                // For calibrate command the --vm is required.
+                if (vm_option.count() == 0)
+                    throw CLI::RequiredError{vm_option.get_name()};
+
+                // The JSON report is the only output.
+                return tooling::calibrate(vm, rev, std::chrono::milliseconds{bench_time_ms},
+                                          std::cout);
+            }
+
+            if (compare_cmd)
+            {
+                if (compare_vm_configs.size() != 2)
+                    throw std::invalid_argument{"compare requires exactly two --vm options"};
+
+                zvmc_loader_error_code ec = ZVMC_LOADER_UNSPECIFIED_ERROR;
+                auto vm_a = load_vm(compare_vm_configs[0], ec);
+                if (ec != ZVMC_LOADER_SUCCESS)
+                    return static_cast<int>(ec);
+                auto vm_b = load_vm(compare_vm_configs[1], ec);
+                if (ec != ZVMC_LOADER_SUCCESS)
+                    return static_cast<int>(ec);
+
+                std::cout << "Config A: " << compare_vm_configs[0] << "\n"
+                          << "Config B: " << compare_vm_configs[1] << "\n";
+
+                const ArgumentBytes code{code_arg};
+                const ArgumentBytes input{input_arg};
+                return tooling::compare(vm_a, vm_b, rev, gas, code, input, std::cout);
+            }
+
+            if (disasm_cmd)
+            {
+                const ArgumentBytes code{code_arg};
+                return tooling::disasm(rev, code, std::cout);
+            }
+
+            if (stats_cmd)
+                return tooling::stats(rev, corpus_dir, stats_top, std::cout);
+
+            if (replay_cmd)
+            {
+                // For replay command the --vm is required.
+                if (vm_option.count() == 0)
+                    throw CLI::RequiredError{vm_option.get_name()};
+
+                std::cout << "Config: " << vm_config << "\n";
+
+                std::ifstream file{trace_file, std::ios::binary};
+                const auto trace = read_trace(file);
+                return tooling::replay(vm, trace, bench, std::cout);
+            }
+
             return 0;
         }
         catch (const CLI::ParseError& e)